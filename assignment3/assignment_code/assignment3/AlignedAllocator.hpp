@@ -0,0 +1,70 @@
+#ifndef ALIGNED_ALLOCATOR_H_
+#define ALIGNED_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace GLOO {
+// Minimal std::allocator replacement returning Alignment-byte aligned
+// storage, so SIMD kernels can use aligned loads on std::vector data.
+template <class T, size_t Alignment>
+class AlignedAllocator {
+ public:
+  using value_type = T;
+
+  template <class U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept {
+  }
+  template <class U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {
+  }
+
+  T* allocate(size_t n) {
+    if (n == 0) {
+      return nullptr;
+    }
+#ifdef _MSC_VER
+    void* ptr = _aligned_malloc(n * sizeof(T), Alignment);
+    if (ptr == nullptr) {
+      throw std::bad_alloc();
+    }
+#else
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, Alignment, n * sizeof(T)) != 0) {
+      throw std::bad_alloc();
+    }
+#endif
+    return static_cast<T*>(ptr);
+  }
+
+  void deallocate(T* ptr, size_t) noexcept {
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+  }
+};
+
+template <class T, class U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&) {
+  return true;
+}
+template <class T, class U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&) {
+  return false;
+}
+}  // namespace GLOO
+
+#endif
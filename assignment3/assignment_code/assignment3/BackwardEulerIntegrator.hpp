@@ -0,0 +1,227 @@
+#ifndef BACKWARD_EULER_INTEGRATOR_H_
+#define BACKWARD_EULER_INTEGRATOR_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "IntegratorBase.hpp"
+#include "FixedParticleState.hpp"
+#include "FixedPendulumSystem.hpp"
+#include "ConjugateGradientSolver.hpp"
+#include "SparseBlockMatrix.hpp"
+
+namespace GLOO {
+// Backward Euler, stable for stiff springs at steps far beyond what the
+// explicit integrators tolerate. Systems that implement LinearizeImplicit
+// take one linearized step (Baraff and Witkin, "Large Steps in Cloth
+// Simulation") solved with preconditioned conjugate gradient, with a
+// multigrid preconditioner for systems that form a large grid; other
+// systems fall back to fixed-point iteration on the derivative. Rigs on
+// FixedParticleState take the same step solved densely, with the Jacobian
+// differenced from the derivative unless the system is a
+// FixedPendulumSystem. Other states throw, since fixed-point iteration
+// diverges at the steps this integrator is meant for.
+template <class TSystem, class TState>
+class BackwardEulerIntegrator : public IntegratorBase<TSystem, TState> {
+ public:
+  BackwardEulerIntegrator() : IntegratorBase<TSystem, TState>(2) {
+  }
+
+  void Step(const TSystem& system,
+            TState& state,
+            float start_time,
+            float dt) const override {
+    if (!LinearizedStep(system, state, start_time, dt)) {
+      FixedPointStep(system, state, start_time, dt);
+    }
+  }
+
+  // Tolerance, iteration limit and statistics of the last solve.
+  ConjugateGradientSolver& GetSolver() {
+    return solver_;
+  }
+  const ConjugateGradientSolver& GetSolver() const {
+    return solver_;
+  }
+
+ private:
+  bool LinearizedStep(const TSystem& system,
+                      ParticleState& state,
+                      float start_time,
+                      float dt) const {
+    if (!system.LinearizeImplicit(state, start_time, dt, lhs_, rhs_)) {
+      return false;
+    }
+    size_t rows = 0;
+    size_t columns = 0;
+    system.GetGrid(rows, columns);
+    solver_.SetGrid(rows, columns); /* 0 x 0 keeps the block diagonal */
+    /* dv_ still holds the previous step's answer, a good first guess */
+    solver_.Solve(lhs_, rhs_, dv_);
+    for (size_t i = 0; i < state.velocities.size(); i++) {
+      state.velocities[i] += dv_[i];
+      state.positions[i] += dt * state.velocities[i];
+    }
+    return true;
+  }
+
+  template <size_t N, size_t S>
+  bool LinearizedStep(const FixedPendulumSystem<N, S>& system,
+                      FixedParticleState<N>& state,
+                      float start_time,
+                      float dt) const {
+    /* the step above, with the 3N x 3N system solved directly */
+    std::array<glm::mat3, N * N> lhs;
+    std::array<glm::vec3, N> rhs;
+    system.LinearizeImplicit(state, start_time, dt, lhs, rhs);
+    const size_t n = 3 * N;
+    std::array<double, 3 * N * 3 * N> m;
+    std::array<double, 3 * N> dv;
+    for (size_t a = 0; a < N; a++) {
+      for (size_t b = 0; b < N; b++) {
+        for (int r = 0; r < 3; r++) {
+          for (int c = 0; c < 3; c++) {
+            m[(3 * a + r) * n + 3 * b + c] = lhs[a * N + b][c][r]; /* glm is column-major */
+          }
+        }
+      }
+      for (int r = 0; r < 3; r++) {
+        dv[3 * a + r] = rhs[a][r];
+      }
+    }
+    if (!SolveDense<3 * N>(m, dv)) {
+      return false;
+    }
+    for (size_t i = 0; i < N; i++) {
+      state.velocities[i] += glm::vec3(dv[3 * i], dv[3 * i + 1], dv[3 * i + 2]);
+      state.positions[i] += dt * state.velocities[i];
+    }
+    return true;
+  }
+
+  template <class TAnySystem, size_t N>
+  bool LinearizedStep(const TAnySystem& system,
+                      FixedParticleState<N>& state,
+                      float start_time,
+                      float dt) const {
+    /* (I - dt J) dy = dt f(y0), with J = df/dy from central differences;
+       6N unknowns, so a dense solve is cheaper than setting up CG */
+    const size_t n = 6 * N;
+    float time = start_time + dt;
+    FixedParticleState<N> f;
+    FixedParticleState<N> plus;
+    FixedParticleState<N> minus;
+    FixedParticleState<N> probe = state;
+    std::array<double, 6 * N * 6 * N> m;
+    std::array<double, 6 * N> dy;
+    for (size_t c = 0; c < n; c++) {
+      float y = Component(state, c);
+      float h = kDifferenceStep * std::max(1.0f, std::fabs(y));
+      Component(probe, c) = y + h;
+      system.ComputeTimeDerivative(probe, time, plus);
+      Component(probe, c) = y - h;
+      system.ComputeTimeDerivative(probe, time, minus);
+      double width = double(y + h) - double(y - h);
+      Component(probe, c) = y;
+      for (size_t r = 0; r < n; r++) {
+        double jacobian = (double(Component(plus, r)) - Component(minus, r)) / width;
+        m[r * n + c] = (r == c ? 1.0 : 0.0) - dt * jacobian;
+      }
+    }
+    system.ComputeTimeDerivative(state, time, f);
+    for (size_t r = 0; r < n; r++) {
+      dy[r] = dt * double(Component(f, r));
+    }
+
+    if (!SolveDense<6 * N>(m, dy)) {
+      return false;
+    }
+    for (size_t r = 0; r < n; r++) {
+      Component(state, r) += float(dy[r]);
+    }
+    return true;
+  }
+
+  template <class TAnySystem, class TOtherState>
+  bool LinearizedStep(const TAnySystem& system,
+                      TOtherState& state,
+                      float start_time,
+                      float dt) const {
+    throw std::runtime_error(
+        "Cannot take backward Euler steps on this particle state!");
+  }
+
+  /* solves m x = b in place by Gaussian elimination with partial
+     pivoting; false if m is singular */
+  template <size_t n>
+  static bool SolveDense(std::array<double, n * n>& m,
+                         std::array<double, n>& b) {
+    for (size_t k = 0; k < n; k++) {
+      size_t pivot = k;
+      for (size_t r = k + 1; r < n; r++) {
+        if (std::fabs(m[r * n + k]) > std::fabs(m[pivot * n + k])) {
+          pivot = r;
+        }
+      }
+      if (m[pivot * n + k] == 0.0) {
+        return false;
+      }
+      if (pivot != k) {
+        for (size_t c = k; c < n; c++) {
+          std::swap(m[k * n + c], m[pivot * n + c]);
+        }
+        std::swap(b[k], b[pivot]);
+      }
+      for (size_t r = k + 1; r < n; r++) {
+        double factor = m[r * n + k] / m[k * n + k];
+        for (size_t c = k; c < n; c++) {
+          m[r * n + c] -= factor * m[k * n + c];
+        }
+        b[r] -= factor * b[k];
+      }
+    }
+    for (size_t k = n; k-- > 0;) {
+      for (size_t c = k + 1; c < n; c++) {
+        b[k] -= m[k * n + c] * b[c];
+      }
+      b[k] /= m[k * n + k];
+    }
+    return true;
+  }
+
+  /* positions then velocities, three components each */
+  template <size_t N>
+  static float& Component(FixedParticleState<N>& state, size_t k) {
+    return k < 3 * N ? state.positions[k / 3][k % 3]
+                     : state.velocities[(k - 3 * N) / 3][k % 3];
+  }
+
+  void FixedPointStep(const TSystem& system,
+                      TState& state,
+                      float start_time,
+                      float dt) const {
+    /* y1 = y0 + dt * f(y1); converges while dt is small next to the
+       system's fastest time scale */
+    TState& start = this->Workspace(0);
+    TState& f = this->Workspace(1);
+    start = state;
+    for (int i = 0; i < kFixedPointIterations; i++) {
+      system.ComputeTimeDerivative(state, start_time + dt, f);
+      AddScaled(state, start, dt, f);
+    }
+  }
+
+  static const int kFixedPointIterations = 8;
+  static constexpr float kDifferenceStep = 1e-3f;
+
+  mutable ConjugateGradientSolver solver_;
+  mutable SparseBlockMatrix lhs_;
+  mutable std::vector<glm::vec3> rhs_;
+  mutable std::vector<glm::vec3> dv_;
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef BATCHED_PARTICLE_STATE_H_
+#define BATCHED_PARTICLE_STATE_H_
+
+#include <cmath>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "AlignedAllocator.hpp"
+#include "SimdKernels.hpp"
+#include "ParticleState.hpp"
+
+namespace GLOO {
+// The states of several independent systems with the same particle count,
+// interleaved so that one SIMD register holds the same quantity of the
+// same particle across systems ("lanes"). Component c of particle i in
+// lane l is at Data()[(c * particles + i) * lane_stride + l], with the
+// components ordered [px, py, pz, vx, vy, vz] and the lane stride padded to
+// a multiple of kSimdWidth. Padding lanes are always zero.
+class BatchedParticleState {
+ public:
+  BatchedParticleState() : lane_count_(0), lane_stride_(0), particle_count_(0) {
+  }
+
+  size_t GetLaneCount() const {
+    return lane_count_;
+  }
+  size_t GetLaneStride() const {
+    return lane_stride_;
+  }
+  size_t GetParticleCount() const {
+    return particle_count_;
+  }
+
+  // Resizes to lane_count systems of particle_count particles; existing
+  // components are not preserved.
+  void Resize(size_t lane_count, size_t particle_count) {
+    size_t lane_stride =
+        (lane_count + kSimdWidth - 1) / kSimdWidth * kSimdWidth;
+    if (lane_count == lane_count_ && particle_count == particle_count_ &&
+        lane_stride == lane_stride_) {
+      return;
+    }
+    lane_count_ = lane_count;
+    lane_stride_ = lane_stride;
+    particle_count_ = particle_count;
+    data_.assign(6 * particle_count_ * lane_stride_, 0.0f);
+  }
+
+  // The lanes of component c (0-2 position, 3-5 velocity) of particle i.
+  float* Lanes(size_t c, size_t i) {
+    return data_.data() + (c * particle_count_ + i) * lane_stride_;
+  }
+  const float* Lanes(size_t c, size_t i) const {
+    return data_.data() + (c * particle_count_ + i) * lane_stride_;
+  }
+  float* Data() {
+    return data_.data();
+  }
+  const float* Data() const {
+    return data_.data();
+  }
+  size_t GetFloatCount() const {
+    return data_.size();
+  }
+
+  void SetSystem(size_t lane, const ParticleState& state) {
+    if (lane >= lane_count_ || state.positions.size() != particle_count_ ||
+        state.velocities.size() != particle_count_) {
+      throw std::runtime_error(
+          "Cannot set a system of inconsistent size in a batched state!");
+    }
+    for (size_t i = 0; i < particle_count_; i++) {
+      for (int k = 0; k < 3; k++) {
+        Lanes(k, i)[lane] = state.positions[i][k];
+        Lanes(3 + k, i)[lane] = state.velocities[i][k];
+      }
+    }
+  }
+
+  void GetSystem(size_t lane, ParticleState& state) const {
+    state.positions.resize(particle_count_);
+    state.velocities.resize(particle_count_);
+    for (size_t i = 0; i < particle_count_; i++) {
+      for (int k = 0; k < 3; k++) {
+        state.positions[i][k] = Lanes(k, i)[lane];
+        state.velocities[i][k] = Lanes(3 + k, i)[lane];
+      }
+    }
+  }
+
+  BatchedParticleState& operator+=(const BatchedParticleState& rhs) {
+    CheckSameShape(rhs);
+    SimdAxpy(Data(), Data(), 1.0f, rhs.Data(), data_.size());
+    return *this;
+  }
+
+  BatchedParticleState& operator*=(float k) {
+    SimdScale(Data(), k, data_.size());
+    return *this;
+  }
+
+  bool operator==(const BatchedParticleState& rhs) const {
+    return lane_count_ == rhs.lane_count_ &&
+           particle_count_ == rhs.particle_count_ && data_ == rhs.data_;
+  }
+
+  void CheckSameShape(const BatchedParticleState& rhs) const {
+    if (lane_count_ != rhs.lane_count_ ||
+        particle_count_ != rhs.particle_count_) {
+      throw std::runtime_error(
+          "Cannot add batched states with inconsistent sizes!");
+    }
+  }
+
+ private:
+  size_t lane_count_;
+  size_t lane_stride_;
+  size_t particle_count_;
+  std::vector<float, AlignedAllocator<float, kSimdAlignment>> data_;
+};
+
+// Batched overloads of the state helpers used by the integrators (see
+// ParticleState.hpp). Positions and velocities are each one contiguous
+// block, so every update is a single streaming SIMD loop.
+inline void AddScaled(BatchedParticleState& out,
+                      const BatchedParticleState& x,
+                      float k,
+                      const BatchedParticleState& y) {
+  x.CheckSameShape(y);
+  out.Resize(x.GetLaneCount(), x.GetParticleCount());
+  SimdAxpy(out.Data(), x.Data(), k, y.Data(), x.GetFloatCount());
+}
+
+inline void Kick(BatchedParticleState& state,
+                 float k,
+                 const BatchedParticleState& derivative) {
+  state.CheckSameShape(derivative);
+  size_t half = state.GetFloatCount() / 2;
+  SimdAxpy(state.Data() + half, state.Data() + half, k,
+           derivative.Data() + half, half);
+}
+
+inline void Drift(BatchedParticleState& state, float k) {
+  size_t half = state.GetFloatCount() / 2;
+  SimdAxpy(state.Data(), state.Data(), k, state.Data() + half, half);
+}
+
+// One error norm over every lane, so an adaptive integrator steps the whole
+// batch at the pace of its least accurate system.
+inline float ScaledErrorNorm(const BatchedParticleState& error,
+                             const BatchedParticleState& y0,
+                             const BatchedParticleState& y1,
+                             float abs_tol,
+                             float rel_tol) {
+  const float* e = error.Data();
+  const float* a = y0.Data();
+  const float* b = y1.Data();
+  float norm = 0.0f;
+  for (size_t i = 0; i < error.GetFloatCount(); i++) {
+    float scale = abs_tol + rel_tol * std::max(std::fabs(a[i]), std::fabs(b[i]));
+    norm = std::max(norm, std::fabs(e[i]) / scale);
+    if (std::isnan(e[i])) {
+      return NAN;
+    }
+  }
+  return norm;
+}
+}  // namespace GLOO
+
+#endif
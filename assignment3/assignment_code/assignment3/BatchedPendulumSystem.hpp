@@ -0,0 +1,144 @@
+#ifndef BATCHED_PENDULUM_SYSTEM_H_
+#define BATCHED_PENDULUM_SYSTEM_H_
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "AlignedAllocator.hpp"
+#include "BatchedParticleState.hpp"
+#include "PendulumSystem.hpp"
+
+namespace GLOO {
+// Many PendulumSystems of one topology stepped together, for parameter
+// sweeps: the masses, springs and pins are shared, and each lane of a
+// BatchedParticleState is one system with its own drag and stiffness scale.
+// Every loop runs over the lanes innermost, a SIMD register at a time, so one
+// integrator call advances all systems together instead of one virtual call
+// each.
+class BatchedPendulumSystem {
+ public:
+  // lane_count copies of prototype's topology and parameters.
+  BatchedPendulumSystem(const PendulumSystem& prototype, size_t lane_count)
+      : masses_(prototype.Masses),
+        springs_(prototype.Springs),
+        fixed_(prototype.Fixed),
+        lane_count_(lane_count),
+        lane_stride_((lane_count + kSimdWidth - 1) / kSimdWidth * kSimdWidth),
+        drag_consts_(lane_stride_, 0.0f),
+        stiffness_scales_(lane_stride_, 0.0f) {
+    std::fill(drag_consts_.begin(), drag_consts_.begin() + lane_count_,
+              prototype.drag_const);
+    std::fill(stiffness_scales_.begin(),
+              stiffness_scales_.begin() + lane_count_, 1.0f);
+  }
+
+  size_t GetLaneCount() const {
+    return lane_count_;
+  }
+  size_t GetParticleCount() const {
+    return masses_.size();
+  }
+
+  void SetDragConst(size_t lane, float drag_const) {
+    drag_consts_[lane] = drag_const;
+  }
+  // Multiplies every spring constant of one system.
+  void SetStiffnessScale(size_t lane, float scale) {
+    stiffness_scales_[lane] = scale;
+  }
+
+  void ComputeTimeDerivative(const BatchedParticleState& state,
+                             float time,
+                             BatchedParticleState& f) const {
+    /* the model of PendulumSystem, one register of lanes at a time, with
+       the same operations in the same order, so each lane matches a
+       separate PendulumSystem exactly; forces accumulate in f's velocity
+       lanes and become accelerations at the end */
+    size_t n = masses_.size();
+    size_t lanes = lane_stride_;
+    if (state.GetLaneCount() != lane_count_ || state.GetParticleCount() != n) {
+      throw std::runtime_error(
+          "Cannot step a batched state of a different size than its system!");
+    }
+    f.Resize(state.GetLaneCount(), n);
+    const SimdFloat zero = SimdSet(0.0f);
+    const SimdFloat one = SimdSet(1.0f);
+
+    for (size_t i = 0; i < n; i++) {
+      SimdFloat w = SimdSet(-float(masses_[i]*9.81)); /* gravity acts in y direction only */
+      for (size_t l = 0; l < lanes; l += kSimdRegisterWidth) {
+        SimdFloat minus_drag = SimdSub(zero, SimdLoad(&drag_consts_[l]));
+        SimdStore(f.Lanes(3, i) + l, SimdAdd(zero, SimdMul(minus_drag, SimdLoad(state.Lanes(3, i) + l))));
+        SimdStore(f.Lanes(4, i) + l, SimdAdd(w, SimdMul(minus_drag, SimdLoad(state.Lanes(4, i) + l))));
+        SimdStore(f.Lanes(5, i) + l, SimdAdd(zero, SimdMul(minus_drag, SimdLoad(state.Lanes(5, i) + l))));
+      }
+    }
+
+    const int* spring_indices = springs_.GetIndices();
+    const float* spring_consts = springs_.GetSpringConsts();
+    const float* rest_lengths = springs_.GetRestLengths();
+    for (size_t s = 0; s < springs_.GetCount(); s++) {
+      int a = spring_indices[2*s];
+      int b = spring_indices[2*s + 1];
+      SimdFloat minus_spring_const = SimdSet(-spring_consts[s]);
+      SimdFloat rest_length = SimdSet(rest_lengths[s]);
+      for (size_t l = 0; l < lanes; l += kSimdRegisterWidth) {
+        SimdFloat dx = SimdSub(SimdLoad(state.Lanes(0, a) + l), SimdLoad(state.Lanes(0, b) + l));
+        SimdFloat dy = SimdSub(SimdLoad(state.Lanes(1, a) + l), SimdLoad(state.Lanes(1, b) + l));
+        SimdFloat dz = SimdSub(SimdLoad(state.Lanes(2, a) + l), SimdLoad(state.Lanes(2, b) + l));
+        SimdFloat norm_d = SimdSqrt(SimdAdd(SimdAdd(SimdMul(dx, dx), SimdMul(dy, dy)), SimdMul(dz, dz)));
+        SimdFloat k = SimdMul(SimdMul(minus_spring_const, SimdLoad(&stiffness_scales_[l])),
+                              SimdSub(norm_d, rest_length));
+        /* coincident particles exert no force, as in PendulumSystem */
+        k = SimdSelectZero(norm_d, zero, k);
+        norm_d = SimdSelectZero(norm_d, one, norm_d);
+        SimdFloat sx = SimdMul(k, SimdDiv(dx, norm_d));
+        SimdFloat sy = SimdMul(k, SimdDiv(dy, norm_d));
+        SimdFloat sz = SimdMul(k, SimdDiv(dz, norm_d));
+        float* fa = f.Lanes(3, a) + l;
+        float* fb = f.Lanes(3, b) + l;
+        size_t component = n * lanes; /* from x to y to z lanes */
+        SimdStore(fa, SimdAdd(SimdLoad(fa), sx));
+        SimdStore(fa + component, SimdAdd(SimdLoad(fa + component), sy));
+        SimdStore(fa + 2 * component, SimdAdd(SimdLoad(fa + 2 * component), sz));
+        SimdStore(fb, SimdSub(SimdLoad(fb), sx));
+        SimdStore(fb + component, SimdSub(SimdLoad(fb + component), sy));
+        SimdStore(fb + 2 * component, SimdSub(SimdLoad(fb + 2 * component), sz));
+      }
+    }
+
+    for (size_t j = 0; j < fixed_.size(); j++) {
+      for (size_t c = 3; c < 6; c++) {
+        std::fill(f.Lanes(c, fixed_[j]), f.Lanes(c, fixed_[j]) + lanes, 0.0f); /* fixed spheres feel no force */
+      }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+      SimdFloat mass = SimdSet(masses_[i]);
+      for (size_t c = 3; c < 6; c++) {
+        float* fc = f.Lanes(c, i);
+        for (size_t l = 0; l < lanes; l += kSimdRegisterWidth) {
+          SimdStore(fc + l, SimdDiv(SimdLoad(fc + l), mass)); /* N2L to calculate acceleration */
+        }
+        std::fill(fc + lane_count_, fc + lanes, 0.0f); /* padding lanes stay at rest */
+      }
+    }
+
+    /* position derivative is the velocity */
+    std::copy(state.Lanes(3, 0), state.Lanes(3, 0) + 3 * n * lanes, f.Lanes(0, 0));
+  }
+
+ private:
+  std::vector<float> masses_;
+  SpringNetwork springs_;
+  std::vector<int> fixed_;
+  size_t lane_count_;
+  size_t lane_stride_;
+  std::vector<float, AlignedAllocator<float, kSimdAlignment>> drag_consts_;
+  std::vector<float, AlignedAllocator<float, kSimdAlignment>> stiffness_scales_;
+};
+}  // namespace GLOO
+
+#endif
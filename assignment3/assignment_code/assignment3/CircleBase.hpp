@@ -2,12 +2,14 @@
 #define CIRCLE_BASE_H_
 
 #include "ParticleState.hpp"
+#include "FixedParticleState.hpp"
 #include "ParticleSystemBase.hpp"
 
 namespace GLOO {
 class CircleBase : public ParticleSystemBase {
  public:
- 
+    using ParticleSystemBase::ComputeTimeDerivative;
+
     ParticleState ComputeTimeDerivative(const ParticleState& state,
                                               float time) const {
                                                 ParticleState f;
@@ -18,6 +20,15 @@ class CircleBase : public ParticleSystemBase {
                                                 f.positions[0].z = 0;
                                                 return f; /* the derivative for circular motion */
                                               }
+
+    /* the same for the single particle held inline: not virtual and never
+       allocates, so integrators on FixedParticleState<1> inline it */
+    void ComputeTimeDerivative(const FixedParticleState<1>& state,
+                               float time,
+                               FixedParticleState<1>& f) const {
+        f.positions[0] = glm::vec3(-1*state.positions[0].y, state.positions[0].x, 0);
+        f.velocities[0] = glm::vec3(0, 0, 0);
+    }
 };
 }  // namespace GLOO
 
@@ -0,0 +1,176 @@
+#include "CollisionSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace GLOO {
+CollisionSolver::CollisionSolver()
+    : particle_radius_(0.05f), friction_(0.0f), particle_collisions_(false) {
+}
+
+void CollisionSolver::AddPlane(const glm::vec3& normal, float offset) {
+  planes_.push_back({glm::normalize(normal), offset});
+}
+
+void CollisionSolver::AddSphere(const glm::vec3& center, float radius) {
+  spheres_.push_back({center, radius});
+}
+
+void CollisionSolver::ClearColliders() {
+  planes_.clear();
+  spheres_.clear();
+}
+
+void CollisionSolver::EnableParticleCollisions(
+    const SpringNetwork& excluded_springs) {
+  excluded_ = excluded_springs;
+  if (!excluded_.IsSorted()) {
+    excluded_.Sort(); /* the row index answers "are a and b joined?" */
+  }
+  particle_collisions_ = true;
+}
+
+void CollisionSolver::DisableParticleCollisions() {
+  particle_collisions_ = false;
+  excluded_.Clear();
+}
+
+void CollisionSolver::SetFixed(const std::vector<int>& fixed) {
+  fixed_mask_.clear();
+  for (int i : fixed) {
+    if (size_t(i) >= fixed_mask_.size()) {
+      fixed_mask_.resize(i + 1, 0);
+    }
+    fixed_mask_[i] = 1;
+  }
+}
+
+template <class TKernel>
+void CollisionSolver::ForEachParticle(size_t count, const TKernel& kernel) {
+  if (thread_pool_ == nullptr) {
+    kernel(0, count);
+  } else {
+    thread_pool_->ParallelFor(count, 1024, std::cref(kernel));
+  }
+}
+
+void CollisionSolver::Resolve(ParticleState& state) {
+  if (particle_collisions_) {
+    ResolveParticles(state);
+  }
+  if (!planes_.empty() || !spheres_.empty()) {
+    ResolveColliders(state);
+  }
+}
+
+bool CollisionSolver::IsExcluded(int a, int b) const {
+  if (a > b) {
+    std::swap(a, b);
+  }
+  if (size_t(a) >= excluded_.GetRowCount()) {
+    return false;
+  }
+  const int* indices = excluded_.GetIndices();
+  size_t begin = excluded_.GetRowBegin(a);
+  size_t end = excluded_.GetRowEnd(a);
+  while (begin < end) {
+    size_t middle = (begin + end) / 2;
+    if (indices[2 * middle + 1] < b) {
+      begin = middle + 1;
+    } else {
+      end = middle;
+    }
+  }
+  return begin < excluded_.GetRowEnd(a) && indices[2 * begin + 1] == b;
+}
+
+void CollisionSolver::RemoveApproach(glm::vec3& velocity,
+                                     const glm::vec3& normal) const {
+  float normal_speed = glm::dot(velocity, normal);
+  if (normal_speed < 0.0f) {
+    glm::vec3 tangential = velocity - normal_speed * normal;
+    velocity = (1.0f - friction_) * tangential;
+  }
+}
+
+void CollisionSolver::ResolveParticles(ParticleState& state) {
+  size_t n = state.positions.size();
+  float contact = 2.0f * particle_radius_;
+  hash_.Build(state.positions, contact);
+  position_deltas_.resize(n);
+  velocity_deltas_.resize(n);
+
+  const std::vector<uint32_t>& order = hash_.GetSortedIndices();
+  ForEachParticle(n, [&](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++) {
+      uint32_t i = order[k];
+      glm::vec3 position_delta(0.0f);
+      glm::vec3 velocity_delta(0.0f);
+      if (!IsFixed(i)) {
+        const glm::vec3& p = state.positions[i];
+        hash_.ForEachNear(p, [&](uint32_t j, const glm::vec3& q) {
+          if (j == i) {
+            return;
+          }
+          glm::vec3 d = p - q;
+          float distance_squared = glm::dot(d, d);
+          if (distance_squared >= contact * contact ||
+              distance_squared == 0.0f || IsExcluded(i, j)) {
+            return;
+          }
+          float distance = std::sqrt(distance_squared);
+          glm::vec3 normal = d / distance;
+          /* each side moves half the overlap unless the other is fixed */
+          float share = IsFixed(j) ? 1.0f : 0.5f;
+          position_delta += share * (contact - distance) * normal;
+          float approach =
+              glm::dot(state.velocities[i] - state.velocities[j], normal);
+          if (approach < 0.0f) {
+            velocity_delta -= share * approach * normal;
+          }
+        });
+      }
+      position_deltas_[i] = position_delta;
+      velocity_deltas_[i] = velocity_delta;
+    }
+  });
+
+  ForEachParticle(n, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      state.positions[i] += position_deltas_[i];
+      state.velocities[i] += velocity_deltas_[i];
+    }
+  });
+}
+
+void CollisionSolver::ResolveColliders(ParticleState& state) {
+  ForEachParticle(state.positions.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      if (IsFixed(i)) {
+        continue;
+      }
+      glm::vec3& p = state.positions[i];
+      glm::vec3& v = state.velocities[i];
+      for (const PlaneCollider& plane : planes_) {
+        float depth = plane.offset + particle_radius_ -
+                      glm::dot(plane.normal, p);
+        if (depth > 0.0f) {
+          p += depth * plane.normal;
+          RemoveApproach(v, plane.normal);
+        }
+      }
+      for (const SphereCollider& sphere : spheres_) {
+        glm::vec3 d = p - sphere.center;
+        float distance = glm::length(d);
+        float depth = sphere.radius + particle_radius_ - distance;
+        if (depth > 0.0f && distance > 0.0f) {
+          glm::vec3 normal = d / distance;
+          p += depth * normal;
+          RemoveApproach(v, normal);
+        }
+      }
+    }
+  });
+}
+}  // namespace GLOO
@@ -0,0 +1,89 @@
+#ifndef COLLISION_SOLVER_H_
+#define COLLISION_SOLVER_H_
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ParticleState.hpp"
+#include "SpatialHash.hpp"
+#include "SpringNetwork.hpp"
+#include "ThreadPool.hpp"
+
+namespace GLOO {
+// Points x with dot(normal, x) >= offset are outside.
+struct PlaneCollider {
+  glm::vec3 normal;
+  float offset;
+};
+
+struct SphereCollider {
+  glm::vec3 center;
+  float radius;
+};
+
+// Resolves contacts after an integration step by moving particles, treated
+// as spheres of one radius, out of each other and out of the colliders,
+// and removing the approaching part of their velocities. Working on the
+// state rather than the forces makes it independent of the integrator.
+//
+// Particle pairs are found with a SpatialHash rebuilt on every call. Each
+// particle sums its own correction from its neighbours' current positions
+// (a Jacobi pass), so particles are processed in parallel without races and
+// the result does not depend on the number of threads.
+class CollisionSolver {
+ public:
+  CollisionSolver();
+
+  void SetParticleRadius(float radius) {
+    particle_radius_ = radius;
+  }
+  // Fraction of the tangential velocity removed on contact, from 0 to 1.
+  void SetFriction(float friction) {
+    friction_ = friction;
+  }
+  void AddPlane(const glm::vec3& normal, float offset);
+  void AddSphere(const glm::vec3& center, float radius);
+  void ClearColliders();
+
+  // Turns on particle-particle collisions. Pairs joined by one of the given
+  // springs are skipped, which for cloth gives self-collision that does not
+  // fight the cloth's own structure.
+  void EnableParticleCollisions(const SpringNetwork& excluded_springs);
+  void DisableParticleCollisions();
+  // Fixed particles are never moved.
+  void SetFixed(const std::vector<int>& fixed);
+  void SetThreadPool(std::shared_ptr<ThreadPool> thread_pool) {
+    thread_pool_ = std::move(thread_pool);
+  }
+
+  void Resolve(ParticleState& state);
+
+ private:
+  template <class TKernel>
+  void ForEachParticle(size_t count, const TKernel& kernel);
+  void ResolveParticles(ParticleState& state);
+  void ResolveColliders(ParticleState& state);
+  bool IsExcluded(int a, int b) const;
+  bool IsFixed(size_t i) const {
+    return i < fixed_mask_.size() && fixed_mask_[i];
+  }
+  void RemoveApproach(glm::vec3& velocity, const glm::vec3& normal) const;
+
+  float particle_radius_;
+  float friction_;
+  std::vector<PlaneCollider> planes_;
+  std::vector<SphereCollider> spheres_;
+  bool particle_collisions_;
+  SpringNetwork excluded_;
+  std::vector<char> fixed_mask_;
+  std::shared_ptr<ThreadPool> thread_pool_;
+
+  SpatialHash hash_;
+  std::vector<glm::vec3> position_deltas_;
+  std::vector<glm::vec3> velocity_deltas_;
+};
+}  // namespace GLOO
+
+#endif
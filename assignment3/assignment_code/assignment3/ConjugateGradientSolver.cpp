@@ -0,0 +1,122 @@
+#include "ConjugateGradientSolver.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include "gloo/utils.hpp"
+
+namespace GLOO {
+namespace {
+// Accumulated in double: float dot products over hundreds of thousands of
+// particles lose enough precision to stall convergence.
+double Dot(const std::vector<glm::vec3>& a, const std::vector<glm::vec3>& b) {
+  double sum = 0.0;
+  for (size_t i = 0; i < a.size(); i++) {
+    sum += double(a[i].x) * b[i].x + double(a[i].y) * b[i].y +
+           double(a[i].z) * b[i].z;
+  }
+  return sum;
+}
+}  // namespace
+
+void ConjugateGradientSolver::SetGrid(size_t rows, size_t columns) {
+  if (rows * columns == 0) {
+    multigrid_.reset();
+  } else if (multigrid_ == nullptr || multigrid_->GetRows() != rows ||
+             multigrid_->GetColumns() != columns) {
+    multigrid_ = make_unique<MultigridPreconditioner>(rows, columns);
+    use_multigrid_ = false;
+  }
+}
+
+size_t ConjugateGradientSolver::Solve(const SparseBlockMatrix& A,
+                                      const std::vector<glm::vec3>& b,
+                                      std::vector<glm::vec3>& x) {
+  size_t n = A.GetSize();
+  if (x.size() != n) {
+    x.assign(n, glm::vec3(0.0f));
+  }
+  bool has_multigrid = multigrid_ != nullptr && multigrid_->GetSize() == n;
+  use_multigrid_ = use_multigrid_ && has_multigrid;
+  if (use_multigrid_) {
+    multigrid_->Setup(A);
+    last_iterations_ = Iterate(A, b, x, max_iterations_);
+    return last_iterations_;
+  }
+
+  inverse_diagonal_.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    inverse_diagonal_[i] = glm::inverse(A.Diagonal(i));
+  }
+  size_t limit = max_iterations_;
+  if (has_multigrid) {
+    limit = std::min(limit, size_t(kMultigridIterations));
+  }
+  last_iterations_ = Iterate(A, b, x, limit);
+  if (has_multigrid && last_residual_ > tolerance_) {
+    /* slow to converge: carry on from x with multigrid, for this solve and
+       the ones after */
+    use_multigrid_ = true;
+    multigrid_->Setup(A);
+    last_iterations_ +=
+        Iterate(A, b, x, max_iterations_ - std::min(max_iterations_, limit));
+  }
+  return last_iterations_;
+}
+
+size_t ConjugateGradientSolver::Iterate(const SparseBlockMatrix& A,
+                                        const std::vector<glm::vec3>& b,
+                                        std::vector<glm::vec3>& x,
+                                        size_t max_iterations) {
+  size_t n = A.GetSize();
+  A.Multiply(x, q_);
+  r_.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    r_[i] = b[i] - q_[i];
+  }
+  Precondition(r_, z_);
+  p_ = z_;
+
+  double b_norm = std::sqrt(Dot(b, b));
+  double threshold = double(tolerance_) * b_norm;
+  double rz = Dot(r_, z_);
+  double r_norm = std::sqrt(Dot(r_, r_));
+  size_t iteration = 0;
+  while (r_norm > threshold && iteration < max_iterations) {
+    A.Multiply(p_, q_);
+    double pq = Dot(p_, q_);
+    if (pq <= 0.0) {
+      break; /* not positive definite along p; keep the best x so far */
+    }
+    float alpha = float(rz / pq);
+    for (size_t i = 0; i < n; i++) {
+      x[i] += alpha * p_[i];
+      r_[i] -= alpha * q_[i];
+    }
+    Precondition(r_, z_);
+    double rz_next = Dot(r_, z_);
+    float beta = float(rz_next / rz);
+    for (size_t i = 0; i < n; i++) {
+      p_[i] = z_[i] + beta * p_[i];
+    }
+    rz = rz_next;
+    r_norm = std::sqrt(Dot(r_, r_));
+    iteration++;
+  }
+
+  last_residual_ = b_norm > 0.0 ? float(r_norm / b_norm) : 0.0f;
+  return iteration;
+}
+
+void ConjugateGradientSolver::Precondition(const std::vector<glm::vec3>& r,
+                                           std::vector<glm::vec3>& z) {
+  if (use_multigrid_) {
+    multigrid_->Apply(r, z);
+    return;
+  }
+  z.resize(r.size());
+  for (size_t i = 0; i < r.size(); i++) {
+    z[i] = inverse_diagonal_[i] * r[i];
+  }
+}
+}  // namespace GLOO
@@ -0,0 +1,80 @@
+#ifndef CONJUGATE_GRADIENT_SOLVER_H_
+#define CONJUGATE_GRADIENT_SOLVER_H_
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "SparseBlockMatrix.hpp"
+#include "MultigridPreconditioner.hpp"
+
+namespace GLOO {
+// Conjugate gradient for symmetric positive definite block matrices,
+// preconditioned with the inverses of the 3x3 diagonal blocks, or with a
+// multigrid V-cycle when the unknowns are known to form a large grid.
+// Scratch vectors are kept between solves, so repeated solves of the same
+// size do not allocate.
+class ConjugateGradientSolver {
+ public:
+  ConjugateGradientSolver() : tolerance_(1e-5f), max_iterations_(200) {
+  }
+
+  // Stops once |b - A x| <= tolerance * |b|.
+  void SetTolerance(float tolerance) {
+    tolerance_ = tolerance;
+  }
+  void SetMaxIterations(size_t max_iterations) {
+    max_iterations_ = max_iterations;
+  }
+  // The unknowns form a rows x columns grid, numbered row by row; 0 x 0
+  // if not. Solves on a grid start out with the block diagonal, which is
+  // cheapest while it converges quickly; the first to need more than
+  // kMultigridIterations carries on, and later solves start, with
+  // MultigridPreconditioner, whose iterations cost several times more but
+  // barely grow in number with the grid's size.
+  void SetGrid(size_t rows, size_t columns);
+  bool IsMultigrid() const {
+    return use_multigrid_;
+  }
+
+  // Solves A x = b, starting from the current contents of x (which is
+  // zeroed if its size does not match). Returns the iterations taken.
+  size_t Solve(const SparseBlockMatrix& A,
+               const std::vector<glm::vec3>& b,
+               std::vector<glm::vec3>& x);
+
+  size_t GetLastIterations() const {
+    return last_iterations_;
+  }
+  // Relative residual |b - A x| / |b| after the last solve.
+  float GetLastResidual() const {
+    return last_residual_;
+  }
+
+ private:
+  size_t Iterate(const SparseBlockMatrix& A,
+                 const std::vector<glm::vec3>& b,
+                 std::vector<glm::vec3>& x,
+                 size_t max_iterations);
+  void Precondition(const std::vector<glm::vec3>& r,
+                    std::vector<glm::vec3>& z);
+
+  static const size_t kMultigridIterations = 100;
+
+  float tolerance_;
+  size_t max_iterations_;
+  size_t last_iterations_ = 0;
+  float last_residual_ = 0.0f;
+
+  std::unique_ptr<MultigridPreconditioner> multigrid_;
+  bool use_multigrid_ = false;
+  std::vector<glm::mat3> inverse_diagonal_;
+  std::vector<glm::vec3> r_;
+  std::vector<glm::vec3> z_;
+  std::vector<glm::vec3> p_;
+  std::vector<glm::vec3> q_;
+};
+}  // namespace GLOO
+
+#endif
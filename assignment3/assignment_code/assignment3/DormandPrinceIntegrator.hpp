@@ -0,0 +1,157 @@
+#ifndef DORMAND_PRINCE_INTEGRATOR_H_
+#define DORMAND_PRINCE_INTEGRATOR_H_
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "IntegratorBase.hpp"
+
+namespace GLOO {
+// Adaptive embedded Runge-Kutta 5(4) (Dormand and Prince). Each Step covers
+// dt with as many substeps as the error tolerance needs: the difference
+// between the 5th and embedded 4th order solutions estimates the local
+// error, steps over tolerance are retried smaller, and the step size
+// carries over between calls, so quiet phases run with few large substeps.
+template <class TSystem, class TState>
+class DormandPrinceIntegrator : public IntegratorBase<TSystem, TState> {
+ public:
+  DormandPrinceIntegrator()
+      : IntegratorBase<TSystem, TState>(9),
+        abs_tol_(1e-4f),
+        rel_tol_(1e-4f),
+        next_step_(0.0f),
+        accepted_steps_(0),
+        rejected_steps_(0) {
+  }
+
+  void Step(const TSystem& system,
+            TState& state,
+            float start_time,
+            float dt) const override {
+    TState& k1 = this->Workspace(0);
+    TState& k2 = this->Workspace(1);
+    TState& k3 = this->Workspace(2);
+    TState& k4 = this->Workspace(3);
+    TState& k5 = this->Workspace(4);
+    TState& k6 = this->Workspace(5);
+    TState& k7 = this->Workspace(6);
+    TState& next = this->Workspace(7);
+    TState& error = this->Workspace(8);
+
+    float h = next_step_ > 0.0f ? next_step_ : dt;
+    float t = start_time;
+    float end_time = start_time + dt;
+    /* never so small that t + step rounds back to t */
+    float min_step = std::max(dt * 1e-6f, 4.0f * FLT_EPSILON * std::fabs(end_time));
+    system.ComputeTimeDerivative(state, t, k1);
+    while (t < end_time) {
+      /* stretch slightly rather than leave a sliver before the end */
+      float remaining = end_time - t;
+      bool last = h * 1.01f >= remaining;
+      float step = last ? remaining : std::max(h, min_step);
+
+      AddScaled(next, state, step * (1.0f / 5), k1);
+      system.ComputeTimeDerivative(next, t + step * (1.0f / 5), k2);
+
+      AddScaled(next, state, step * (3.0f / 40), k1);
+      AddScaled(next, next, step * (9.0f / 40), k2);
+      system.ComputeTimeDerivative(next, t + step * (3.0f / 10), k3);
+
+      AddScaled(next, state, step * (44.0f / 45), k1);
+      AddScaled(next, next, step * (-56.0f / 15), k2);
+      AddScaled(next, next, step * (32.0f / 9), k3);
+      system.ComputeTimeDerivative(next, t + step * (4.0f / 5), k4);
+
+      AddScaled(next, state, step * (19372.0f / 6561), k1);
+      AddScaled(next, next, step * (-25360.0f / 2187), k2);
+      AddScaled(next, next, step * (64448.0f / 6561), k3);
+      AddScaled(next, next, step * (-212.0f / 729), k4);
+      system.ComputeTimeDerivative(next, t + step * (8.0f / 9), k5);
+
+      AddScaled(next, state, step * (9017.0f / 3168), k1);
+      AddScaled(next, next, step * (-355.0f / 33), k2);
+      AddScaled(next, next, step * (46732.0f / 5247), k3);
+      AddScaled(next, next, step * (49.0f / 176), k4);
+      AddScaled(next, next, step * (-5103.0f / 18656), k5);
+      system.ComputeTimeDerivative(next, t + step, k6);
+
+      // 5th order solution; its derivative is the next step's k1.
+      AddScaled(next, state, step * (35.0f / 384), k1);
+      AddScaled(next, next, step * (500.0f / 1113), k3);
+      AddScaled(next, next, step * (125.0f / 192), k4);
+      AddScaled(next, next, step * (-2187.0f / 6784), k5);
+      AddScaled(next, next, step * (11.0f / 84), k6);
+      system.ComputeTimeDerivative(next, t + step, k7);
+
+      // Difference to the embedded 4th order solution.
+      error = k1;
+      error *= step * (71.0f / 57600);
+      AddScaled(error, error, step * (-71.0f / 16695), k3);
+      AddScaled(error, error, step * (71.0f / 1920), k4);
+      AddScaled(error, error, step * (-17253.0f / 339200), k5);
+      AddScaled(error, error, step * (22.0f / 525), k6);
+      AddScaled(error, error, step * (-1.0f / 40), k7);
+
+      float norm = ScaledErrorNorm(error, state, next, abs_tol_, rel_tol_);
+      if (!std::isfinite(norm) && step <= min_step) {
+        throw std::runtime_error("Cannot integrate a diverging system!");
+      }
+      /* past the minimum step the error is accepted, unless not finite */
+      bool accept = std::isfinite(norm) && (norm <= 1.0f || step <= min_step);
+      /* usual safety factor, growth limited to 5x and shrinking to 0.2x */
+      float factor = 0.2f;
+      if (std::isfinite(norm)) {
+        factor = norm > 0.0f ? 0.9f * std::pow(norm, -0.2f) : 5.0f;
+        factor = std::min(5.0f, std::max(0.2f, factor));
+      }
+
+      if (accept) {
+        std::swap(state, next);
+        std::swap(k1, k7);
+        if (!last && t + step == t) {
+          throw std::runtime_error("Cannot advance time by so small a step!");
+        }
+        t = last ? end_time : t + step;
+        accepted_steps_++;
+        /* a step cut short by the end of dt says nothing about h */
+        if (!(last && step < h)) {
+          h = step * factor;
+        }
+      } else {
+        rejected_steps_++;
+        h = step * std::min(factor, 1.0f);
+      }
+    }
+    next_step_ = h;
+  }
+
+  bool IsAdaptive() const override {
+    return true;
+  }
+  size_t GetAcceptedSteps() const override {
+    return accepted_steps_;
+  }
+  size_t GetRejectedSteps() const override {
+    return rejected_steps_;
+  }
+
+  // Per-component tolerance abs_tol + rel_tol * |value| on positions and
+  // velocities.
+  void SetTolerances(float abs_tol, float rel_tol) {
+    abs_tol_ = abs_tol;
+    rel_tol_ = rel_tol;
+  }
+
+ private:
+  float abs_tol_;
+  float rel_tol_;
+  mutable float next_step_;
+  mutable size_t accepted_steps_;
+  mutable size_t rejected_steps_;
+};
+}  // namespace GLOO
+
+#endif
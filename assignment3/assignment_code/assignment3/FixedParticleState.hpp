@@ -0,0 +1,147 @@
+#ifndef FIXED_PARTICLE_STATE_H_
+#define FIXED_PARTICLE_STATE_H_
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "ParticleState.hpp"
+
+namespace GLOO {
+// The state of a system of exactly N particles, held inline. Copying,
+// adding and scaling never allocate, and every loop has a compile-time trip
+// count, so for small N the integrators built on the helpers below unroll
+// to straight-line code. Many small rigs can be kept in one contiguous
+// array of these.
+template <size_t N>
+struct FixedParticleState {
+  std::array<glm::vec3, N> positions;
+  std::array<glm::vec3, N> velocities;
+
+  FixedParticleState& operator+=(const FixedParticleState& rhs) {
+    for (size_t i = 0; i < N; i++) {
+      positions[i] += rhs.positions[i];
+      velocities[i] += rhs.velocities[i];
+    }
+    return *this;
+  }
+
+  bool operator==(const FixedParticleState& rhs) const {
+    return positions == rhs.positions && velocities == rhs.velocities;
+  }
+
+  FixedParticleState& operator*=(float k) {
+    for (size_t i = 0; i < N; i++) {
+      positions[i] *= k;
+      velocities[i] *= k;
+    }
+    return *this;
+  }
+};
+
+template <size_t N>
+inline FixedParticleState<N> operator+(FixedParticleState<N> s1,
+                                       const FixedParticleState<N>& s2) {
+  s1 += s2;
+  return s1;
+}
+template <size_t N>
+inline FixedParticleState<N> operator*(FixedParticleState<N> s1, float k) {
+  s1 *= k;
+  return s1;
+}
+template <size_t N>
+inline FixedParticleState<N> operator*(float k, FixedParticleState<N> s1) {
+  s1 *= k;
+  return s1;
+}
+
+// Conversions from and to the dynamic state, which must have N particles.
+template <size_t N>
+inline FixedParticleState<N> MakeFixedState(const ParticleState& state) {
+  if (state.positions.size() != N || state.velocities.size() != N) {
+    throw std::runtime_error(
+        "Cannot fix the size of a particle state of a different size!");
+  }
+  FixedParticleState<N> fixed;
+  std::copy(state.positions.begin(), state.positions.end(),
+            fixed.positions.begin());
+  std::copy(state.velocities.begin(), state.velocities.end(),
+            fixed.velocities.begin());
+  return fixed;
+}
+
+template <size_t N>
+inline ParticleState MakeDynamicState(const FixedParticleState<N>& fixed) {
+  ParticleState state;
+  state.positions.assign(fixed.positions.begin(), fixed.positions.end());
+  state.velocities.assign(fixed.velocities.begin(), fixed.velocities.end());
+  return state;
+}
+
+// Fixed-size overloads of the state helpers used by the integrators (see
+// ParticleState.hpp). The sizes match by construction, so nothing is
+// checked.
+template <size_t N>
+inline void AddScaled(FixedParticleState<N>& out,
+                      const FixedParticleState<N>& x,
+                      float k,
+                      const FixedParticleState<N>& y) {
+  for (size_t i = 0; i < N; i++) {
+    out.positions[i] = x.positions[i] + k * y.positions[i];
+  }
+  for (size_t i = 0; i < N; i++) {
+    out.velocities[i] = x.velocities[i] + k * y.velocities[i];
+  }
+}
+
+template <size_t N>
+inline void Kick(FixedParticleState<N>& state,
+                 float k,
+                 const FixedParticleState<N>& derivative) {
+  for (size_t i = 0; i < N; i++) {
+    state.velocities[i] += k * derivative.velocities[i];
+  }
+}
+
+template <size_t N>
+inline void Drift(FixedParticleState<N>& state, float k) {
+  for (size_t i = 0; i < N; i++) {
+    state.positions[i] += k * state.velocities[i];
+  }
+}
+
+template <size_t N>
+inline float ScaledErrorNorm(const FixedParticleState<N>& error,
+                             const FixedParticleState<N>& y0,
+                             const FixedParticleState<N>& y1,
+                             float abs_tol,
+                             float rel_tol) {
+  float norm = 0.0f;
+  auto accumulate = [&](const glm::vec3& e, const glm::vec3& a,
+                        const glm::vec3& b) {
+    for (int c = 0; c < 3; c++) {
+      float scale =
+          abs_tol + rel_tol * std::max(std::fabs(a[c]), std::fabs(b[c]));
+      norm = std::max(norm, std::fabs(e[c]) / scale);
+      if (std::isnan(e[c])) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (size_t i = 0; i < N; i++) {
+    if (!accumulate(error.positions[i], y0.positions[i], y1.positions[i]) ||
+        !accumulate(error.velocities[i], y0.velocities[i],
+                    y1.velocities[i])) {
+      return NAN;
+    }
+  }
+  return norm;
+}
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef FIXED_PENDULUM_SYSTEM_H_
+#define FIXED_PENDULUM_SYSTEM_H_
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+#include "FixedParticleState.hpp"
+#include "PendulumSystem.hpp"
+
+namespace GLOO {
+// A PendulumSystem of exactly N particles and S springs, for small rigs
+// such as secondary motion on characters. Masses, springs and pins are held
+// inline, and ComputeTimeDerivative is not virtual, so an integrator
+// instantiated on this and FixedParticleState<N> inlines the model into
+// straight-line code that never allocates. One system can be shared by any
+// number of rigs, each rig being one FixedParticleState, but each rig needs
+// its own integrator: integrators carry state from step to step, such as
+// Verlet's last derivative and RK45's step size.
+template <size_t N, size_t S>
+class FixedPendulumSystem {
+ public:
+  // prototype's masses, springs, pins, drag and fields; throws unless it
+  // has exactly N particles and S springs.
+  explicit FixedPendulumSystem(const PendulumSystem& prototype)
+      : drag_const_(prototype.drag_const), fields_(prototype.Fields) {
+    if (prototype.Masses.size() != N || prototype.Springs.GetCount() != S) {
+      throw std::runtime_error(
+          "Cannot fix the size of a system of a different size!");
+    }
+    fixed_.fill(false);
+    for (size_t i = 0; i < N; i++) {
+      masses_[i] = prototype.Masses[i];
+    }
+    for (int i : prototype.Fixed) {
+      if (i < 0 || size_t(i) >= N) {
+        throw std::runtime_error("Cannot fix particle " + std::to_string(i) +
+                                 " of a system of " + std::to_string(N) + "!");
+      }
+      fixed_[i] = true;
+    }
+    for (size_t s = 0; s < S; s++) {
+      if (size_t(prototype.Springs.GetSecond(s)) >= N) { /* the larger endpoint */
+        throw std::runtime_error("Cannot attach a spring to particle " +
+                                 std::to_string(prototype.Springs.GetSecond(s)) +
+                                 " of a system of " + std::to_string(N) + "!");
+      }
+      firsts_[s] = prototype.Springs.GetFirst(s);
+      seconds_[s] = prototype.Springs.GetSecond(s);
+      spring_consts_[s] = prototype.Springs.GetSpringConst(s);
+      rest_lengths_[s] = prototype.Springs.GetRestLength(s);
+    }
+  }
+
+  void ComputeTimeDerivative(const FixedParticleState<N>& state,
+                             float time,
+                             FixedParticleState<N>& f) const {
+    /* the model of PendulumSystem, with the same operations in the same
+       order, so a rig matches a PendulumSystem exactly; forces accumulate
+       in f.velocities and become accelerations at the end */
+    std::array<glm::vec3, N>& forces = f.velocities;
+    for (size_t i = 0; i < N; i++) {
+      float w = masses_[i]*9.81;
+      glm::vec3 weight = glm::vec3(0, -w, 0); /* gravity acts in y direction only */
+      glm::vec3 drag = -drag_const_*state.velocities[i]; /* viscous drag force */
+      forces[i] = weight + drag;
+    }
+    if (!fields_.IsEmpty()) {
+      fields_.AddForces(state.positions.data(), state.velocities.data(),
+                        masses_.data(), time, N, forces.data());
+    }
+
+    for (size_t s = 0; s < S; s++) {
+      glm::vec3 d = state.positions[firsts_[s]] - state.positions[seconds_[s]];
+      float norm_d = glm::length(d);
+      glm::vec3 spring_force;
+      if (norm_d == 0) {
+        spring_force = glm::vec3(0, 0, 0);
+      } else {
+        spring_force = -spring_consts_[s]*(norm_d - rest_lengths_[s])*(d/norm_d);
+      }
+      forces[firsts_[s]] += spring_force;
+      forces[seconds_[s]] -= spring_force;
+    }
+
+    for (size_t i = 0; i < N; i++) {
+      if (fixed_[i]) {
+        forces[i] = glm::vec3(0, 0, 0); /* fixed spheres feel no force */
+      }
+      forces[i] = forces[i]/masses_[i]; /* N2L to calculate acceleration */
+    }
+
+    f.positions = state.velocities; /* position derivative is the velocity */
+  }
+
+  // PendulumSystem::LinearizeImplicit with the matrix held densely:
+  // lhs[a * N + b] is the block coupling particles a and b.
+  void LinearizeImplicit(const FixedParticleState<N>& state,
+                         float time,
+                         float dt,
+                         std::array<glm::mat3, N * N>& lhs,
+                         std::array<glm::vec3, N>& rhs) const {
+    lhs.fill(glm::mat3(0.0f));
+    for (size_t i = 0; i < N; i++) {
+      glm::vec3 weight = glm::vec3(0, -masses_[i]*9.81f, 0);
+      glm::vec3 drag = -drag_const_*state.velocities[i];
+      rhs[i] = weight + drag;
+      lhs[i * N + i] = glm::mat3(masses_[i] + dt*(drag_const_ + fields_.GetDrag())); /* df/dv = -(drag_const + field drag) */
+    }
+    if (!fields_.IsEmpty()) {
+      /* the fields' dependence on position is left explicit */
+      fields_.AddForces(state.positions.data(), state.velocities.data(),
+                        masses_.data(), time, N, rhs.data());
+    }
+    for (size_t i = 0; i < N; i++) {
+      rhs[i] = dt*rhs[i];
+    }
+
+    for (size_t s = 0; s < S; s++) {
+      int a = firsts_[s];
+      int b = seconds_[s];
+      glm::vec3 d = state.positions[a] - state.positions[b];
+      float norm_d = glm::length(d);
+      if (norm_d == 0) {
+        continue;
+      }
+      glm::vec3 dir = d/norm_d;
+      glm::vec3 spring_force = -spring_consts_[s]*(norm_d - rest_lengths_[s])*dir;
+
+      glm::mat3 outer = glm::outerProduct(dir, dir);
+      float transverse = std::max(0.0f, 1 - rest_lengths_[s]/norm_d);
+      glm::mat3 stiffness = spring_consts_[s]*(outer + transverse*(glm::mat3(1.0f) - outer));
+
+      glm::vec3 impulse = dt*(spring_force - dt*(stiffness*(state.velocities[a] - state.velocities[b])));
+      rhs[a] += impulse;
+      rhs[b] -= impulse;
+      lhs[a * N + a] += dt*dt*stiffness;
+      lhs[b * N + b] += dt*dt*stiffness;
+      lhs[a * N + b] -= dt*dt*stiffness;
+      lhs[b * N + a] -= dt*dt*stiffness;
+    }
+
+    for (size_t i = 0; i < N; i++) {
+      if (fixed_[i]) {
+        /* fixed spheres get dv = 0 and are decoupled from their neighbours */
+        for (size_t j = 0; j < N; j++) {
+          lhs[i * N + j] = glm::mat3(0.0f);
+          lhs[j * N + i] = glm::mat3(0.0f);
+        }
+        lhs[i * N + i] = glm::mat3(1.0f);
+        rhs[i] = glm::vec3(0, 0, 0);
+      }
+    }
+  }
+
+ private:
+  std::array<float, N> masses_;
+  std::array<bool, N> fixed_;
+  std::array<int, S> firsts_;
+  std::array<int, S> seconds_;
+  std::array<float, S> spring_consts_;
+  std::array<float, S> rest_lengths_;
+  float drag_const_;
+  ForceFields fields_;
+};
+}  // namespace GLOO
+
+#endif
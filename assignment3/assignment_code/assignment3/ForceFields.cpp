@@ -0,0 +1,250 @@
+#include "ForceFields.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "SimdKernels.hpp"
+
+namespace GLOO {
+namespace {
+const size_t kTileSize = 256;
+const int kTurbulenceModes = 16;
+}  // namespace
+
+// Scratch for one tile of particles: positions, velocities and masses in,
+// forces out. Floats past the tile's particles are zero.
+struct ForceFields::Tile {
+  alignas(kSimdAlignment) float px[kTileSize];
+  alignas(kSimdAlignment) float py[kTileSize];
+  alignas(kSimdAlignment) float pz[kTileSize];
+  alignas(kSimdAlignment) float vx[kTileSize];
+  alignas(kSimdAlignment) float vy[kTileSize];
+  alignas(kSimdAlignment) float vz[kTileSize];
+  alignas(kSimdAlignment) float masses[kTileSize];
+  alignas(kSimdAlignment) float fx[kTileSize];
+  alignas(kSimdAlignment) float fy[kTileSize];
+  alignas(kSimdAlignment) float fz[kTileSize];
+};
+
+void ForceFields::AddWind(const WindField& wind) {
+  winds_.push_back(wind);
+  drag_ += wind.drag;
+}
+
+void ForceFields::AddVortex(const VortexField& vortex) {
+  if (vortex.core_radius <= 0.0f || glm::length(vortex.axis) == 0.0f) {
+    throw std::runtime_error("Cannot add a vortex without a core or axis!");
+  }
+  VortexField normalized = vortex;
+  normalized.axis = glm::normalize(vortex.axis);
+  vortices_.push_back(normalized);
+  drag_ += vortex.drag;
+}
+
+void ForceFields::AddAttractor(const AttractorField& attractor) {
+  attractors_.push_back(attractor);
+}
+
+void ForceFields::AddTurbulence(const TurbulenceField& turbulence) {
+  if (turbulence.length_scale <= 0.0f) {
+    throw std::runtime_error("Cannot add turbulence without a length scale!");
+  }
+  std::mt19937 random(turbulence.seed);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  auto random_direction = [&]() {
+    float z = 2.0f * uniform(random) - 1.0f;
+    float angle = 6.2831853f * uniform(random);
+    float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+    return glm::vec3(r * std::cos(angle), r * std::sin(angle), z);
+  };
+
+  /* wavelengths log-spaced over an octave band below length_scale, with
+     the amplitudes of a k^-5/3 energy spectrum sampled at log spacing */
+  std::vector<TurbulenceMode> modes(kTurbulenceModes);
+  float energy = 0.0f;
+  for (int m = 0; m < kTurbulenceModes; m++) {
+    float octaves = 3.0f * (m + uniform(random)) / kTurbulenceModes;
+    float k = 6.2831853f / turbulence.length_scale * std::exp2(octaves);
+    glm::vec3 direction = random_direction();
+    glm::vec3 polarization = glm::cross(direction, random_direction());
+    while (glm::dot(polarization, polarization) < 1e-6f) {
+      polarization = glm::cross(direction, random_direction());
+    }
+    TurbulenceMode& mode = modes[m];
+    mode.wave_vector = k * direction;
+    mode.frequency = k * turbulence.speed; /* eddies turn over as they pass */
+    mode.phase = 6.2831853f * uniform(random);
+    mode.amplitude = std::pow(k, -1.0f / 3.0f) * glm::normalize(polarization);
+    energy += 0.5f * glm::dot(mode.amplitude, mode.amplitude);
+  }
+  float scale = energy > 0.0f ? turbulence.speed / std::sqrt(energy) : 0.0f;
+  for (TurbulenceMode& mode : modes) {
+    mode.amplitude *= scale * turbulence.drag; /* stored as force per velocity */
+    modes_.push_back(mode);
+  }
+  drag_ += turbulence.drag;
+}
+
+void ForceFields::Clear() {
+  winds_.clear();
+  vortices_.clear();
+  attractors_.clear();
+  modes_.clear();
+  drag_ = 0.0f;
+}
+
+void ForceFields::AddForces(const glm::vec3* positions,
+                            const glm::vec3* velocities,
+                            const float* masses,
+                            float time,
+                            size_t count,
+                            glm::vec3* forces) const {
+  Tile tile;
+  for (size_t begin = 0; begin < count; begin += kTileSize) {
+    size_t n = std::min(kTileSize, count - begin);
+    for (size_t i = 0; i < n; i++) {
+      tile.px[i] = positions[begin + i].x;
+      tile.py[i] = positions[begin + i].y;
+      tile.pz[i] = positions[begin + i].z;
+      tile.vx[i] = velocities[begin + i].x;
+      tile.vy[i] = velocities[begin + i].y;
+      tile.vz[i] = velocities[begin + i].z;
+      tile.masses[i] = masses[begin + i];
+    }
+    ApplyTile(tile, n, time);
+    for (size_t i = 0; i < n; i++) {
+      forces[begin + i] += glm::vec3(tile.fx[i], tile.fy[i], tile.fz[i]);
+    }
+  }
+}
+
+void ForceFields::AddForces(const float* px,
+                            const float* py,
+                            const float* pz,
+                            const float* vx,
+                            const float* vy,
+                            const float* vz,
+                            const float* masses,
+                            float time,
+                            size_t count,
+                            float* fx,
+                            float* fy,
+                            float* fz) const {
+  Tile tile;
+  for (size_t begin = 0; begin < count; begin += kTileSize) {
+    size_t n = std::min(kTileSize, count - begin);
+    std::copy(px + begin, px + begin + n, tile.px);
+    std::copy(py + begin, py + begin + n, tile.py);
+    std::copy(pz + begin, pz + begin + n, tile.pz);
+    std::copy(vx + begin, vx + begin + n, tile.vx);
+    std::copy(vy + begin, vy + begin + n, tile.vy);
+    std::copy(vz + begin, vz + begin + n, tile.vz);
+    std::copy(masses + begin, masses + begin + n, tile.masses);
+    ApplyTile(tile, n, time);
+    for (size_t i = 0; i < n; i++) {
+      fx[begin + i] += tile.fx[i];
+      fy[begin + i] += tile.fy[i];
+      fz[begin + i] += tile.fz[i];
+    }
+  }
+}
+
+void ForceFields::ApplyTile(Tile& tile, size_t count, float time) const {
+  size_t padded = (count + kSimdRegisterWidth - 1) / kSimdRegisterWidth *
+                  kSimdRegisterWidth;
+  for (size_t i = count; i < padded; i++) {
+    tile.px[i] = tile.py[i] = tile.pz[i] = 0.0f;
+    tile.vx[i] = tile.vy[i] = tile.vz[i] = 0.0f;
+    tile.masses[i] = 0.0f;
+  }
+
+  /* the air fields sum to drag-weighted air velocity w, and together pull
+     with w - drag_ * v; uniform wind is the same for every particle */
+  glm::vec3 wind(0.0f);
+  for (const WindField& field : winds_) {
+    float gust = 1.0f + field.gust * std::sin(6.2831853f *
+                                              field.gust_frequency * time);
+    wind += field.drag * gust * field.velocity;
+  }
+  SimdFloat wind_x = SimdSet(wind.x);
+  SimdFloat wind_y = SimdSet(wind.y);
+  SimdFloat wind_z = SimdSet(wind.z);
+  SimdFloat drag = SimdSet(drag_);
+  for (size_t i = 0; i < padded; i += kSimdRegisterWidth) {
+    SimdStore(tile.fx + i, SimdSub(wind_x, SimdMul(drag, SimdLoad(tile.vx + i))));
+    SimdStore(tile.fy + i, SimdSub(wind_y, SimdMul(drag, SimdLoad(tile.vy + i))));
+    SimdStore(tile.fz + i, SimdSub(wind_z, SimdMul(drag, SimdLoad(tile.vz + i))));
+  }
+
+  for (const VortexField& field : vortices_) {
+    /* cross(axis, r) has length equal to the distance from the axis */
+    SimdFloat cx = SimdSet(field.center.x);
+    SimdFloat cy = SimdSet(field.center.y);
+    SimdFloat cz = SimdSet(field.center.z);
+    SimdFloat ax = SimdSet(field.axis.x);
+    SimdFloat ay = SimdSet(field.axis.y);
+    SimdFloat az = SimdSet(field.axis.z);
+    SimdFloat core2 = SimdSet(field.core_radius * field.core_radius);
+    SimdFloat gain = SimdSet(2.0f * field.speed * field.core_radius * field.drag);
+    for (size_t i = 0; i < padded; i += kSimdRegisterWidth) {
+      SimdFloat rx = SimdSub(SimdLoad(tile.px + i), cx);
+      SimdFloat ry = SimdSub(SimdLoad(tile.py + i), cy);
+      SimdFloat rz = SimdSub(SimdLoad(tile.pz + i), cz);
+      SimdFloat along = SimdAdd(SimdAdd(SimdMul(rx, ax), SimdMul(ry, ay)), SimdMul(rz, az));
+      SimdFloat r2 = SimdAdd(SimdAdd(SimdMul(rx, rx), SimdMul(ry, ry)), SimdMul(rz, rz));
+      SimdFloat radial2 = SimdSub(r2, SimdMul(along, along));
+      SimdFloat s = SimdDiv(gain, SimdAdd(radial2, core2));
+      SimdFloat tx = SimdSub(SimdMul(ay, rz), SimdMul(az, ry));
+      SimdFloat ty = SimdSub(SimdMul(az, rx), SimdMul(ax, rz));
+      SimdFloat tz = SimdSub(SimdMul(ax, ry), SimdMul(ay, rx));
+      SimdStore(tile.fx + i, SimdAdd(SimdLoad(tile.fx + i), SimdMul(s, tx)));
+      SimdStore(tile.fy + i, SimdAdd(SimdLoad(tile.fy + i), SimdMul(s, ty)));
+      SimdStore(tile.fz + i, SimdAdd(SimdLoad(tile.fz + i), SimdMul(s, tz)));
+    }
+  }
+
+  for (const TurbulenceMode& mode : modes_) {
+    SimdFloat kx = SimdSet(mode.wave_vector.x);
+    SimdFloat ky = SimdSet(mode.wave_vector.y);
+    SimdFloat kz = SimdSet(mode.wave_vector.z);
+    SimdFloat offset = SimdSet(mode.frequency * time + mode.phase);
+    SimdFloat amplitude_x = SimdSet(mode.amplitude.x);
+    SimdFloat amplitude_y = SimdSet(mode.amplitude.y);
+    SimdFloat amplitude_z = SimdSet(mode.amplitude.z);
+    for (size_t i = 0; i < padded; i += kSimdRegisterWidth) {
+      SimdFloat angle = SimdAdd(SimdAdd(SimdAdd(SimdMul(kx, SimdLoad(tile.px + i)),
+                                                SimdMul(ky, SimdLoad(tile.py + i))),
+                                        SimdMul(kz, SimdLoad(tile.pz + i))),
+                                offset);
+      SimdFloat c = SimdCos(angle);
+      SimdStore(tile.fx + i, SimdAdd(SimdLoad(tile.fx + i), SimdMul(amplitude_x, c)));
+      SimdStore(tile.fy + i, SimdAdd(SimdLoad(tile.fy + i), SimdMul(amplitude_y, c)));
+      SimdStore(tile.fz + i, SimdAdd(SimdLoad(tile.fz + i), SimdMul(amplitude_z, c)));
+    }
+  }
+
+  for (const AttractorField& field : attractors_) {
+    SimdFloat cx = SimdSet(field.center.x);
+    SimdFloat cy = SimdSet(field.center.y);
+    SimdFloat cz = SimdSet(field.center.z);
+    SimdFloat softening2 = SimdSet(field.softening * field.softening);
+    SimdFloat strength = SimdSet(field.strength);
+    for (size_t i = 0; i < padded; i += kSimdRegisterWidth) {
+      SimdFloat dx = SimdSub(cx, SimdLoad(tile.px + i));
+      SimdFloat dy = SimdSub(cy, SimdLoad(tile.py + i));
+      SimdFloat dz = SimdSub(cz, SimdLoad(tile.pz + i));
+      SimdFloat d2 = SimdAdd(SimdAdd(SimdAdd(SimdMul(dx, dx), SimdMul(dy, dy)), SimdMul(dz, dz)),
+                             softening2);
+      /* m * strength / d^3; a particle right on an unsoftened center feels nothing */
+      SimdFloat d3 = SimdMul(d2, SimdSqrt(d2));
+      SimdFloat s = SimdSelectZero(d3, SimdSet(0.0f),
+                                   SimdDiv(SimdMul(strength, SimdLoad(tile.masses + i)), d3));
+      SimdStore(tile.fx + i, SimdAdd(SimdLoad(tile.fx + i), SimdMul(s, dx)));
+      SimdStore(tile.fy + i, SimdAdd(SimdLoad(tile.fy + i), SimdMul(s, dy)));
+      SimdStore(tile.fz + i, SimdAdd(SimdLoad(tile.fz + i), SimdMul(s, dz)));
+    }
+  }
+}
+}  // namespace GLOO
@@ -0,0 +1,116 @@
+#ifndef FORCE_FIELDS_H_
+#define FORCE_FIELDS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace GLOO {
+// Wind, vortex and turbulence are velocity fields of the air, which pulls
+// each particle towards the local air velocity u with force drag * (u - v).
+// Cloth thus streams with the wind and flutters in turbulence instead of
+// accelerating without bound.
+
+// Uniform air velocity, scaled by 1 + gust * sin(2 pi gust_frequency t).
+struct WindField {
+  glm::vec3 velocity;
+  float drag;
+  float gust = 0.0f;
+  float gust_frequency = 0.0f;
+};
+
+// Air swirling right-handedly about the line through center along axis.
+// Its speed rises from zero on the line to speed at core_radius and falls
+// off as 1 / distance beyond.
+struct VortexField {
+  glm::vec3 center;
+  glm::vec3 axis;
+  float speed;
+  float core_radius;
+  float drag;
+};
+
+// Pulls particles towards center with acceleration strength / distance^2
+// (negative strength pushes them away), softened within softening of the
+// center so that it stays finite there.
+struct AttractorField {
+  glm::vec3 center;
+  float strength;
+  float softening;
+};
+
+// Divergence-free ("curl noise") air motion: a sum of random Fourier modes
+// u = sum a_m cos(k_m . x + omega_m t + phi_m) with a_m perpendicular to
+// k_m, each the curl of a sine wave potential. Wavelengths span an octave
+// band down from length_scale, amplitudes follow the Kolmogorov spectrum,
+// and speed is the root mean square air speed.
+struct TurbulenceField {
+  float speed;
+  float length_scale;
+  float drag;
+  uint32_t seed = 1;
+};
+
+// External force fields, applied in bulk. Particles are processed in tiles
+// copied to aligned structure-of-arrays scratch, and each kind of field
+// runs as one SIMD loop over the tile, so a field costs a handful of
+// instructions per particle and there is no per-particle dispatch.
+class ForceFields {
+ public:
+  void AddWind(const WindField& wind);
+  void AddVortex(const VortexField& vortex);
+  void AddAttractor(const AttractorField& attractor);
+  void AddTurbulence(const TurbulenceField& turbulence);
+  void Clear();
+  bool IsEmpty() const {
+    return winds_.empty() && vortices_.empty() && attractors_.empty() &&
+           modes_.empty();
+  }
+
+  // Sum of the air fields' drags: -df/dv, for implicit integrators.
+  float GetDrag() const {
+    return drag_;
+  }
+
+  // Adds the forces on count particles at time to forces.
+  void AddForces(const glm::vec3* positions,
+                 const glm::vec3* velocities,
+                 const float* masses,
+                 float time,
+                 size_t count,
+                 glm::vec3* forces) const;
+  // The same on separate component arrays.
+  void AddForces(const float* px,
+                 const float* py,
+                 const float* pz,
+                 const float* vx,
+                 const float* vy,
+                 const float* vz,
+                 const float* masses,
+                 float time,
+                 size_t count,
+                 float* fx,
+                 float* fy,
+                 float* fz) const;
+
+ private:
+  struct Tile;
+  struct TurbulenceMode {
+    glm::vec3 wave_vector;
+    float frequency;
+    float phase;
+    glm::vec3 amplitude;
+  };
+
+  void ApplyTile(Tile& tile, size_t count, float time) const;
+
+  std::vector<WindField> winds_;
+  std::vector<VortexField> vortices_;
+  std::vector<AttractorField> attractors_;
+  std::vector<TurbulenceMode> modes_;
+  float drag_ = 0.0f;
+};
+}  // namespace GLOO
+
+#endif
@@ -7,13 +7,17 @@
 namespace GLOO {
 template <class TSystem, class TState>
 class ForwardEulerIntegrator : public IntegratorBase<TSystem, TState> {
-  TState Integrate(const TSystem& system,
-                   const TState& state,
-                   float start_time,
-                   float dt) const override {
-                    
-    TState f = system.ComputeTimeDerivative(state, start_time);
-    return state + dt*f; /* euler integration */
+ public:
+  ForwardEulerIntegrator() : IntegratorBase<TSystem, TState>(1) {
+  }
+
+  void Step(const TSystem& system,
+            TState& state,
+            float start_time,
+            float dt) const override {
+    TState& f = this->Workspace(0);
+    system.ComputeTimeDerivative(state, start_time, f);
+    AddScaled(state, state, dt, f); /* euler integration */
   }
 };
 }  // namespace GLOO
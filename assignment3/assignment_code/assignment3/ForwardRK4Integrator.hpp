@@ -6,20 +6,35 @@
 namespace GLOO {
 template <class TSystem, class TState>
 class ForwardRK4Integrator : public IntegratorBase<TSystem, TState> {
-  TState Integrate(const TSystem& system,
-                   const TState& state,
-                   float start_time,
-                   float dt) const override {
+ public:
+  ForwardRK4Integrator() : IntegratorBase<TSystem, TState>(5) {
+  }
+
+  void Step(const TSystem& system,
+            TState& state,
+            float start_time,
+            float dt) const override {
+    TState& k1 = this->Workspace(0);
+    TState& k2 = this->Workspace(1);
+    TState& k3 = this->Workspace(2);
+    TState& k4 = this->Workspace(3);
+    TState& temp = this->Workspace(4);
 
-    TState k1 = system.ComputeTimeDerivative(state, start_time);
-    TState k2 = system.ComputeTimeDerivative(state + (dt/2.0)*k1, start_time + (dt/2.0));
-    TState k3 = system.ComputeTimeDerivative(state + (dt/2.0)*k2, start_time + (dt/2.0));
-    TState k4 = system.ComputeTimeDerivative(state + dt*k3, start_time + dt);
+    system.ComputeTimeDerivative(state, start_time, k1);
+    AddScaled(temp, state, dt / 2.0f, k1);
+    system.ComputeTimeDerivative(temp, start_time + dt / 2.0f, k2);
+    AddScaled(temp, state, dt / 2.0f, k2);
+    system.ComputeTimeDerivative(temp, start_time + dt / 2.0f, k3);
+    AddScaled(temp, state, dt, k3);
+    system.ComputeTimeDerivative(temp, start_time + dt, k4);
 
-    TState f = state + (dt/6.0) * (k1 + 2*k2 + 2*k3 + k4);
-    return f;
+    // temp = k1 + 2*k2 + 2*k3 + k4
+    AddScaled(temp, k1, 2.0f, k2);
+    AddScaled(temp, temp, 2.0f, k3);
+    AddScaled(temp, temp, 1.0f, k4);
+    AddScaled(state, state, dt / 6.0f, temp);
   }
 };
 }  // namespace GLOO
 
-#endif
\ No newline at end of file
+#endif
@@ -6,16 +6,25 @@
 namespace GLOO {
 template <class TSystem, class TState>
 class ForwardTrapezoidalIntegrator : public IntegratorBase<TSystem, TState> {
-  TState Integrate(const TSystem& system,
-                   const TState& state,
-                   float start_time,
-                   float dt) const override {
+ public:
+  ForwardTrapezoidalIntegrator() : IntegratorBase<TSystem, TState>(3) {
+  }
+
+  void Step(const TSystem& system,
+            TState& state,
+            float start_time,
+            float dt) const override {
+    TState& f_0 = this->Workspace(0);
+    TState& f_1 = this->Workspace(1);
+    TState& temp = this->Workspace(2);
 
-    TState f_0 = system.ComputeTimeDerivative(state, start_time);
-    TState f_1 = system.ComputeTimeDerivative(state + dt*f_0, start_time + dt);
-    return state + (dt/2.0)*(f_0 + f_1); /* trapezoidal integration */
+    system.ComputeTimeDerivative(state, start_time, f_0);
+    AddScaled(temp, state, dt, f_0);
+    system.ComputeTimeDerivative(temp, start_time + dt, f_1);
+    AddScaled(temp, f_0, 1.0f, f_1);
+    AddScaled(state, state, dt / 2.0f, temp); /* trapezoidal integration */
   }
 };
 }  // namespace GLOO
 
-#endif
\ No newline at end of file
+#endif
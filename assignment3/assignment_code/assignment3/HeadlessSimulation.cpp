@@ -0,0 +1,63 @@
+#include "HeadlessSimulation.hpp"
+
+#include "IntegratorFactory.hpp"
+#include "SystemFactory.hpp"
+
+namespace GLOO {
+HeadlessSimulation::HeadlessSimulation(IntegratorType type,
+                                       float step,
+                                       bool cloth,
+                                       size_t thread_count)
+    : step_(step), time_(0.0f) {
+  if (cloth) {
+    ClothDescription description;
+    state_ = SystemFactory::CreateClothState(description);
+    SystemFactory::BuildCloth(description, system_, collisions_);
+    SetThreadCount(thread_count);
+  } else {
+    state_ = SystemFactory::CreatePendulumState();
+    SystemFactory::BuildPendulum(state_, system_);
+  }
+  integrator_ =
+      IntegratorFactory::CreateIntegrator<PendulumSystem, ParticleState>(
+          type, state_);
+}
+
+HeadlessSimulation::HeadlessSimulation(
+    const SimulationDescription& description,
+    size_t thread_count)
+    : step_(description.step), time_(0.0f) {
+  state_ = SystemFactory::CreateClothState(description.cloth);
+  SystemFactory::BuildCloth(description.cloth, system_, collisions_);
+  system_.Fields = description.fields;
+  SetThreadCount(thread_count);
+  islands_.SetSleepThreshold(description.sleep_energy,
+                             description.sleep_delay);
+  integrator_ =
+      IntegratorFactory::CreateIntegrator<PendulumSystem, ParticleState>(
+          description.integrator, state_);
+}
+
+void HeadlessSimulation::SetThreadCount(size_t thread_count) {
+  if (thread_count != 1) {
+    auto thread_pool = std::make_shared<ThreadPool>(thread_count);
+    collisions_.SetThreadPool(thread_pool);
+    system_.SetThreadPool(thread_pool);
+  }
+}
+
+size_t HeadlessSimulation::Run(double duration, TrajectoryWriter* trajectory) {
+  if (trajectory != nullptr) {
+    trajectory->WriteFrame(time_, state_);
+  }
+  size_t step_count = size_t(duration / step_ + 0.5);
+  for (size_t i = 0; i < step_count; i++) {
+    islands_.Step(*integrator_, system_, collisions_, state_, time_, step_);
+    time_ += step_;
+    if (trajectory != nullptr) {
+      trajectory->WriteFrame(time_, state_);
+    }
+  }
+  return step_count;
+}
+}  // namespace GLOO
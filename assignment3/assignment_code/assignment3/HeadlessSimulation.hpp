@@ -0,0 +1,57 @@
+#ifndef HEADLESS_SIMULATION_H_
+#define HEADLESS_SIMULATION_H_
+
+#include <memory>
+
+#include "IntegratorBase.hpp"
+#include "IntegratorType.hpp"
+#include "ParticleState.hpp"
+#include "PendulumSystem.hpp"
+#include "CollisionSolver.hpp"
+#include "SleepingIslands.hpp"
+#include "Trajectory.hpp"
+#include "SimulationDescription.hpp"
+
+namespace GLOO {
+// The pendulum or cloth of the viewer, stepped without a window or GL
+// context, for batch runs and for comparing integrators by trajectory.
+class HeadlessSimulation {
+ public:
+  HeadlessSimulation(IntegratorType type,
+                     float step,
+                     bool cloth,
+                     size_t thread_count = 1);
+  // A generated cloth stepped as its description says.
+  explicit HeadlessSimulation(const SimulationDescription& description,
+                              size_t thread_count = 1);
+
+  // Steps through the given simulated time as fast as possible, writing the
+  // initial state and the state after every step when trajectory is not
+  // null. Adaptive integrators treat the step as a frame and substep within
+  // it. Returns the number of steps.
+  size_t Run(double duration, TrajectoryWriter* trajectory);
+
+  const ParticleState& GetState() const {
+    return state_;
+  }
+  float GetStep() const {
+    return step_;
+  }
+  SleepingIslands& GetIslands() {
+    return islands_;
+  }
+
+ private:
+  void SetThreadCount(size_t thread_count);
+
+  ParticleState state_;
+  PendulumSystem system_;
+  CollisionSolver collisions_;
+  SleepingIslands islands_;
+  std::unique_ptr<IntegratorBase<PendulumSystem, ParticleState>> integrator_;
+  float step_;
+  float time_;
+};
+}  // namespace GLOO
+
+#endif
@@ -1,19 +1,66 @@
 #ifndef INTEGRATOR_BASE_H_
 #define INTEGRATOR_BASE_H_
 
+#include <vector>
+
 #include "ParticleSystemBase.hpp"
 
 namespace GLOO {
 template <class TSystem, class TState>
 class IntegratorBase {
  public:
+  explicit IntegratorBase(size_t workspace_size = 0)
+      : workspace_(workspace_size) {
+  }
   virtual ~IntegratorBase() {
   }
 
-  virtual TState Integrate(const TSystem& system,
-                           const TState& state,
-                           float start_time,
-                           float dt) const = 0;
+  // Advances state by dt in place, using the integrator's workspace for
+  // intermediate states. After the first step (or ReserveWorkspace) this
+  // does not allocate as long as the system's in-place
+  // ComputeTimeDerivative does not.
+  virtual void Step(const TSystem& system,
+                    TState& state,
+                    float start_time,
+                    float dt) const = 0;
+
+  TState Integrate(const TSystem& system,
+                   const TState& state,
+                   float start_time,
+                   float dt) const {
+    TState next = state;
+    Step(system, next, start_time, dt);
+    return next;
+  }
+
+  // Adaptive integrators split each Step into substeps of their own size, so
+  // callers can hand them whole frames; they count the substeps they kept
+  // and the ones they retried with a smaller size.
+  virtual bool IsAdaptive() const {
+    return false;
+  }
+  virtual size_t GetAcceptedSteps() const {
+    return 0;
+  }
+  virtual size_t GetRejectedSteps() const {
+    return 0;
+  }
+
+  // Sizes every scratch state like prototype, so that even the first Step
+  // does not allocate.
+  void ReserveWorkspace(const TState& prototype) {
+    for (TState& scratch : workspace_) {
+      scratch = prototype;
+    }
+  }
+
+ protected:
+  TState& Workspace(size_t index) const {
+    return workspace_[index];
+  }
+
+ private:
+  mutable std::vector<TState> workspace_;
 };
 }  // namespace GLOO
 
@@ -12,6 +12,11 @@
 #include "ForwardEulerIntegrator.hpp"
 #include "ForwardTrapezoidalIntegrator.hpp"
 #include "ForwardRK4Integrator.hpp"
+#include "BackwardEulerIntegrator.hpp"
+#include "DormandPrinceIntegrator.hpp"
+#include "SymplecticEulerIntegrator.hpp"
+#include "VelocityVerletIntegrator.hpp"
+#include "XpbdIntegrator.hpp"
 
 namespace GLOO {
 class IntegratorFactory {
@@ -25,11 +30,50 @@ class IntegratorFactory {
         else if (type == IntegratorType::Trapezoidal) {
           return make_unique<ForwardTrapezoidalIntegrator<TSystem, TState>>();
         }
+        else if (type == IntegratorType::BackwardEuler) {
+          return make_unique<BackwardEulerIntegrator<TSystem, TState>>();
+        }
+        else if (type == IntegratorType::RK45) {
+          return make_unique<DormandPrinceIntegrator<TSystem, TState>>();
+        }
+        else if (type == IntegratorType::SymplecticEuler) {
+          return make_unique<SymplecticEulerIntegrator<TSystem, TState>>();
+        }
+        else if (type == IntegratorType::VelocityVerlet) {
+          return make_unique<VelocityVerletIntegrator<TSystem, TState>>();
+        }
+        else if (type == IntegratorType::Xpbd) {
+          return CreateXpbdIntegrator<TSystem, TState>();
+        }
         else {
           return make_unique<ForwardRK4Integrator<TSystem, TState>>();
         }
   }
+
+  // Same as above, with the workspace already sized like prototype.
+  template <class TSystem, class TState>
+  static std::unique_ptr<IntegratorBase<TSystem, TState>> CreateIntegrator(
+      IntegratorType type,
+      const TState& prototype) {
+    auto integrator = CreateIntegrator<TSystem, TState>(type);
+    integrator->ReserveWorkspace(prototype);
+    return integrator;
+  }
+
+ private:
+  // XPBD works on masses and springs, so it only exists for PendulumSystem.
+  template <class TSystem, class TState>
+  static std::unique_ptr<IntegratorBase<TSystem, TState>>
+  CreateXpbdIntegrator() {
+    throw std::runtime_error("XPBD only applies to spring systems!");
+  }
 };
+
+template <>
+inline std::unique_ptr<IntegratorBase<PendulumSystem, ParticleState>>
+IntegratorFactory::CreateXpbdIntegrator<PendulumSystem, ParticleState>() {
+  return make_unique<XpbdIntegrator>();
+}
 }  // namespace GLOO
 
 #endif
@@ -1,8 +1,55 @@
 #ifndef INTEGRATOR_TYPE_H_
 #define INTEGRATOR_TYPE_H_
 
+#include <stdexcept>
+#include <string>
+
 namespace GLOO {
-enum class IntegratorType { Euler, Trapezoidal, RK4 };
+enum class IntegratorType {
+  Euler,
+  Trapezoidal,
+  RK4,
+  BackwardEuler,
+  RK45,
+  SymplecticEuler,
+  VelocityVerlet,
+  Xpbd
+};
+
+// The command-line letters: e, t, r, i, a, s, v, x.
+inline IntegratorType ParseIntegratorType(char c) {
+  IntegratorType integrator_type;
+  switch (c) {
+    case 'e':
+      integrator_type = IntegratorType::Euler;
+      break;
+    case 't':
+      integrator_type = IntegratorType::Trapezoidal;
+      break;
+    case 'r':
+      integrator_type = IntegratorType::RK4;
+      break;
+    case 'i':
+      integrator_type = IntegratorType::BackwardEuler;
+      break;
+    case 'a':
+      integrator_type = IntegratorType::RK45;
+      break;
+    case 's':
+      integrator_type = IntegratorType::SymplecticEuler;
+      break;
+    case 'v':
+      integrator_type = IntegratorType::VelocityVerlet;
+      break;
+    case 'x':
+      integrator_type = IntegratorType::Xpbd;
+      break;
+    default:
+      throw std::runtime_error(
+          "Unrecognized integrator type: " + std::string(1, c) + ".");
+  }
+  return integrator_type;
+}
 }
 
 #endif
@@ -0,0 +1,389 @@
+#include "MultigridPreconditioner.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace GLOO {
+namespace {
+// Levels stop coarsening at this many nodes, which are solved directly.
+const size_t kCoarsestSize = 64;
+
+// Every other node along an axis, plus the last; axes of three nodes or
+// fewer are left as they are.
+size_t Coarsen(size_t nodes) {
+  return nodes > 3 ? nodes / 2 + 1 : nodes;
+}
+
+// Up to two coarse nodes and weights that interpolate fine node f along an
+// axis; returns how many.
+int AxisParents(size_t f, bool coarsened, size_t* parents, float* weights) {
+  if (!coarsened) {
+    parents[0] = f;
+    weights[0] = 1.0f;
+    return 1;
+  }
+  parents[0] = f / 2;
+  if (f % 2 == 0) {
+    weights[0] = 1.0f;
+    return 1;
+  }
+  parents[1] = f / 2 + 1;
+  weights[0] = weights[1] = 0.5f;
+  return 2;
+}
+
+// The slot of block (row, column), column < row, in a level's sorted rows.
+int LowerSlot(const std::vector<int>& offsets,
+              const std::vector<int>& neighbours,
+              int row,
+              int column) {
+  return int(std::lower_bound(neighbours.begin() + offsets[row],
+                              neighbours.begin() + offsets[row + 1], column) -
+             neighbours.begin());
+}
+}  // namespace
+
+MultigridPreconditioner::MultigridPreconditioner(size_t rows, size_t columns) {
+  levels_.emplace_back();
+  levels_[0].rows = rows;
+  levels_[0].columns = columns;
+  while (true) {
+    size_t fine_rows = levels_.back().rows;
+    size_t fine_columns = levels_.back().columns;
+    size_t coarse_rows = Coarsen(fine_rows);
+    size_t coarse_columns = Coarsen(fine_columns);
+    if (fine_rows * fine_columns <= kCoarsestSize ||
+        (coarse_rows == fine_rows && coarse_columns == fine_columns)) {
+      break;
+    }
+    levels_.emplace_back();
+    levels_.back().rows = coarse_rows;
+    levels_.back().columns = coarse_columns;
+    BuildInterpolation(levels_[levels_.size() - 2], levels_.back());
+  }
+}
+
+void MultigridPreconditioner::BuildInterpolation(Level& fine,
+                                                 const Level& coarse) {
+  size_t n = fine.rows * fine.columns;
+  fine.parents.assign(4 * n, 0);
+  fine.weights.assign(4 * n, 0.0f);
+  bool rows_coarsened = coarse.rows != fine.rows;
+  bool columns_coarsened = coarse.columns != fine.columns;
+  for (size_t r = 0; r < fine.rows; r++) {
+    size_t row_parents[2];
+    float row_weights[2];
+    int row_count = AxisParents(r, rows_coarsened, row_parents, row_weights);
+    for (size_t c = 0; c < fine.columns; c++) {
+      size_t column_parents[2];
+      float column_weights[2];
+      int column_count =
+          AxisParents(c, columns_coarsened, column_parents, column_weights);
+      size_t slot = 4 * (r * fine.columns + c);
+      for (int i = 0; i < row_count; i++) {
+        for (int j = 0; j < column_count; j++) {
+          fine.parents[slot] =
+              int(row_parents[i] * coarse.columns + column_parents[j]);
+          fine.weights[slot] = row_weights[i] * column_weights[j];
+          slot++;
+        }
+      }
+    }
+  }
+}
+
+void MultigridPreconditioner::Setup(const SparseBlockMatrix& A) {
+  if (A.GetSize() != GetSize()) {
+    throw std::runtime_error(
+        "Cannot set up multigrid for a matrix of a different size!");
+  }
+  bool same_pattern = pairs_.size() == 2 * A.GetBlockCount();
+  for (size_t k = 0; same_pattern && k < A.GetBlockCount(); k++) {
+    same_pattern = pairs_[2 * k] == A.GetRow(k) &&
+                   pairs_[2 * k + 1] == A.GetColumn(k);
+  }
+  if (!same_pattern) {
+    BuildFinePattern(A);
+    for (size_t l = 1; l < levels_.size(); l++) {
+      BuildCoarsePattern(levels_[l - 1], levels_[l]);
+    }
+  }
+
+  Level& fine = levels_[0];
+  for (size_t i = 0; i < A.GetSize(); i++) {
+    fine.diagonal[i] = A.Diagonal(i);
+  }
+  for (size_t k = 0; k < A.GetBlockCount(); k++) {
+    const glm::mat3& block = A.OffDiagonal(k);
+    if (pair_slots_[k] < 0) {
+      fine.diagonal[A.GetRow(k)] += block + glm::transpose(block);
+    } else {
+      fine.blocks[pair_slots_[k]] =
+          pair_transposed_[k] ? glm::transpose(block) : block;
+    }
+  }
+  for (size_t l = 1; l < levels_.size(); l++) {
+    ProjectCoarse(levels_[l - 1], levels_[l]);
+  }
+  for (Level& level : levels_) {
+    size_t n = level.rows * level.columns;
+    level.inverse_diagonal.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      level.inverse_diagonal[i] = glm::inverse(level.diagonal[i]);
+    }
+    level.x.resize(n);
+    level.b.resize(n);
+    level.scratch.resize(n);
+  }
+  FactorCoarsest();
+}
+
+void MultigridPreconditioner::BuildFinePattern(const SparseBlockMatrix& A) {
+  Level& fine = levels_[0];
+  size_t n = A.GetSize();
+  size_t pair_count = A.GetBlockCount();
+  pairs_.resize(2 * pair_count);
+  fine.offsets.assign(n + 1, 0);
+  for (size_t k = 0; k < pair_count; k++) {
+    int row = A.GetRow(k);
+    int column = A.GetColumn(k);
+    pairs_[2 * k] = row;
+    pairs_[2 * k + 1] = column;
+    if (row != column) {
+      fine.offsets[std::max(row, column) + 1]++;
+    }
+  }
+  for (size_t i = 0; i < n; i++) {
+    fine.offsets[i + 1] += fine.offsets[i];
+  }
+
+  std::vector<int> cursor(fine.offsets.begin(), fine.offsets.end() - 1);
+  fine.neighbours.resize(fine.offsets[n]);
+  fine.blocks.resize(fine.offsets[n]);
+  fine.diagonal.resize(n);
+  pair_slots_.resize(pair_count);
+  pair_transposed_.resize(pair_count);
+  for (size_t k = 0; k < pair_count; k++) {
+    int row = A.GetRow(k);
+    int column = A.GetColumn(k);
+    if (row == column) {
+      pair_slots_[k] = -1; /* folded into the diagonal */
+      continue;
+    }
+    int lower_row = std::max(row, column);
+    pair_slots_[k] = cursor[lower_row];
+    pair_transposed_[k] = row < column;
+    fine.neighbours[cursor[lower_row]++] = std::min(row, column);
+  }
+}
+
+void MultigridPreconditioner::BuildCoarsePattern(const Level& fine,
+                                                 Level& coarse) {
+  /* coarse J < I are neighbours if a fine node interpolated from I is, or
+     neighbours, one interpolated from J */
+  size_t n = coarse.rows * coarse.columns;
+  std::vector<std::vector<int>> rows(n);
+  auto link = [&](int i, int j) {
+    for (int p = 4 * i; p < 4 * i + 4; p++) {
+      for (int q = 4 * j; q < 4 * j + 4; q++) {
+        if (fine.weights[p] > 0.0f && fine.weights[q] > 0.0f &&
+            fine.parents[p] != fine.parents[q]) {
+          int I = std::max(fine.parents[p], fine.parents[q]);
+          rows[I].push_back(std::min(fine.parents[p], fine.parents[q]));
+        }
+      }
+    }
+  };
+  for (size_t j = 0; j < fine.rows * fine.columns; j++) {
+    link(int(j), int(j));
+    for (int s = fine.offsets[j]; s < fine.offsets[j + 1]; s++) {
+      link(int(j), fine.neighbours[s]);
+    }
+  }
+
+  coarse.offsets.assign(n + 1, 0);
+  coarse.neighbours.clear();
+  for (size_t I = 0; I < n; I++) {
+    std::sort(rows[I].begin(), rows[I].end());
+    rows[I].erase(std::unique(rows[I].begin(), rows[I].end()), rows[I].end());
+    coarse.neighbours.insert(coarse.neighbours.end(), rows[I].begin(),
+                             rows[I].end());
+    coarse.offsets[I + 1] = int(coarse.neighbours.size());
+    std::vector<int>().swap(rows[I]);
+  }
+  coarse.blocks.resize(coarse.neighbours.size());
+  coarse.diagonal.resize(n);
+}
+
+void MultigridPreconditioner::ProjectCoarse(const Level& fine, Level& coarse) {
+  /* A_c = P^T A P: each block A_ij of the whole fine matrix adds
+     w_p w_q A_ij to coarse block (I, J), of which only the diagonal and
+     the blocks below it are kept */
+  std::fill(coarse.diagonal.begin(), coarse.diagonal.end(), glm::mat3(0.0f));
+  std::fill(coarse.blocks.begin(), coarse.blocks.end(), glm::mat3(0.0f));
+  auto add = [&](int i, int j, const glm::mat3& block) {
+    for (int p = 4 * i; p < 4 * i + 4; p++) {
+      if (fine.weights[p] == 0.0f) {
+        continue;
+      }
+      for (int q = 4 * j; q < 4 * j + 4; q++) {
+        if (fine.weights[q] == 0.0f) {
+          continue;
+        }
+        int I = fine.parents[p];
+        int J = fine.parents[q];
+        if (J > I) {
+          continue; /* the transposed fine block adds its mirror image */
+        }
+        glm::mat3 weighted = (fine.weights[p] * fine.weights[q]) * block;
+        if (I == J) {
+          coarse.diagonal[I] += weighted;
+        } else {
+          coarse.blocks[LowerSlot(coarse.offsets, coarse.neighbours, I, J)] +=
+              weighted;
+        }
+      }
+    }
+  };
+  for (size_t j = 0; j < fine.rows * fine.columns; j++) {
+    add(int(j), int(j), fine.diagonal[j]);
+    for (int s = fine.offsets[j]; s < fine.offsets[j + 1]; s++) {
+      int i = fine.neighbours[s];
+      add(int(j), i, fine.blocks[s]);
+      add(i, int(j), glm::transpose(fine.blocks[s]));
+    }
+  }
+}
+
+void MultigridPreconditioner::FactorCoarsest() {
+  /* dense lower Cholesky factor, row major; glm blocks are column major */
+  const Level& level = levels_.back();
+  size_t n = level.rows * level.columns;
+  size_t m = 3 * n;
+  cholesky_.assign(m * m, 0.0);
+  auto set = [&](size_t I, size_t J, const glm::mat3& block) {
+    for (int row = 0; row < 3; row++) {
+      for (int column = 0; column < 3; column++) {
+        cholesky_[(3 * I + row) * m + 3 * J + column] = block[column][row];
+      }
+    }
+  };
+  for (size_t I = 0; I < n; I++) {
+    set(I, I, level.diagonal[I]);
+    for (int s = level.offsets[I]; s < level.offsets[I + 1]; s++) {
+      set(I, size_t(level.neighbours[s]), level.blocks[s]);
+    }
+  }
+  for (size_t j = 0; j < m; j++) {
+    double pivot = cholesky_[j * m + j];
+    for (size_t k = 0; k < j; k++) {
+      pivot -= cholesky_[j * m + k] * cholesky_[j * m + k];
+    }
+    if (!(pivot > 0.0)) {
+      cholesky_.clear();
+      return;
+    }
+    pivot = std::sqrt(pivot);
+    cholesky_[j * m + j] = pivot;
+    for (size_t i = j + 1; i < m; i++) {
+      double sum = cholesky_[i * m + j];
+      for (size_t k = 0; k < j; k++) {
+        sum -= cholesky_[i * m + k] * cholesky_[j * m + k];
+      }
+      cholesky_[i * m + j] = sum / pivot;
+    }
+  }
+  dense_rhs_.resize(m);
+}
+
+void MultigridPreconditioner::SolveCoarsest() {
+  Level& level = levels_.back();
+  if (cholesky_.empty()) {
+    for (size_t i = 0; i < level.x.size(); i++) {
+      level.x[i] = level.inverse_diagonal[i] * level.b[i];
+    }
+    return;
+  }
+  size_t m = dense_rhs_.size();
+  for (size_t i = 0; i < m; i++) {
+    double sum = level.b[i / 3][i % 3];
+    for (size_t k = 0; k < i; k++) {
+      sum -= cholesky_[i * m + k] * dense_rhs_[k];
+    }
+    dense_rhs_[i] = sum / cholesky_[i * m + i];
+  }
+  for (size_t i = m; i-- > 0;) {
+    double sum = dense_rhs_[i];
+    for (size_t k = i + 1; k < m; k++) {
+      sum -= cholesky_[k * m + i] * dense_rhs_[k];
+    }
+    dense_rhs_[i] = sum / cholesky_[i * m + i];
+  }
+  for (size_t i = 0; i < m; i++) {
+    level.x[i / 3][i % 3] = float(dense_rhs_[i]);
+  }
+}
+
+void MultigridPreconditioner::Cycle(size_t l) {
+  if (l + 1 == levels_.size()) {
+    SolveCoarsest();
+    return;
+  }
+  Level& level = levels_[l];
+  Level& coarse = levels_[l + 1];
+  int n = int(level.rows * level.columns);
+  std::vector<glm::vec3>& x = level.x;
+  std::vector<glm::vec3>& scratch = level.scratch;
+
+  /* forward block Gauss-Seidel from zero needs only the blocks below the
+     diagonal and leaves the residual b - A x = -U x, which the same blocks
+     transposed gather as the sweep goes */
+  std::fill(scratch.begin(), scratch.end(), glm::vec3(0.0f));
+  for (int j = 0; j < n; j++) {
+    glm::vec3 sum = level.b[j];
+    for (int s = level.offsets[j]; s < level.offsets[j + 1]; s++) {
+      sum -= level.blocks[s] * x[level.neighbours[s]];
+    }
+    x[j] = level.inverse_diagonal[j] * sum;
+    for (int s = level.offsets[j]; s < level.offsets[j + 1]; s++) {
+      scratch[level.neighbours[s]] -= x[j] * level.blocks[s]; /* A_ij x_j = A_ji^T x_j */
+    }
+  }
+
+  std::fill(coarse.b.begin(), coarse.b.end(), glm::vec3(0.0f));
+  for (int i = 0; i < n; i++) {
+    for (int q = 4 * i; q < 4 * i + 4; q++) {
+      coarse.b[level.parents[q]] += level.weights[q] * scratch[i];
+    }
+  }
+  Cycle(l + 1);
+  for (int i = 0; i < n; i++) {
+    for (int q = 4 * i; q < 4 * i + 4; q++) {
+      x[i] += level.weights[q] * coarse.x[level.parents[q]];
+    }
+  }
+
+  /* the backward sweep, the forward one's adjoint so the cycle stays
+     symmetric: blocks below the diagonal meet the old x, and updated
+     values reach the rows above through scratch */
+  std::fill(scratch.begin(), scratch.end(), glm::vec3(0.0f));
+  for (int j = n - 1; j >= 0; j--) {
+    glm::vec3 sum = level.b[j] - scratch[j];
+    for (int s = level.offsets[j]; s < level.offsets[j + 1]; s++) {
+      sum -= level.blocks[s] * x[level.neighbours[s]];
+    }
+    x[j] = level.inverse_diagonal[j] * sum;
+    for (int s = level.offsets[j]; s < level.offsets[j + 1]; s++) {
+      scratch[level.neighbours[s]] += x[j] * level.blocks[s];
+    }
+  }
+}
+
+void MultigridPreconditioner::Apply(const std::vector<glm::vec3>& r,
+                                    std::vector<glm::vec3>& z) {
+  std::copy(r.begin(), r.end(), levels_[0].b.begin());
+  Cycle(0);
+  z = levels_[0].x;
+}
+}  // namespace GLOO
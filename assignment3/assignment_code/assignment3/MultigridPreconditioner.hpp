@@ -0,0 +1,89 @@
+#ifndef MULTIGRID_PRECONDITIONER_H_
+#define MULTIGRID_PRECONDITIONER_H_
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "SparseBlockMatrix.hpp"
+
+namespace GLOO {
+// Geometric multigrid for block systems on a grid of rows x columns
+// particles, numbered row by row as the cloths of SystemFactory. Each
+// coarser level keeps every other row and column (and the last), with
+// bilinear interpolation between levels and coarse matrices formed as
+// P^T A P, so they follow the fine springs' stiffness and pins without
+// knowing about either. One V-cycle, with a forward block Gauss-Seidel
+// sweep on the way down, the transposed sweep on the way up and a direct
+// solve on the coarsest level, is a symmetric positive definite
+// approximation of A^-1: as a conjugate gradient preconditioner it spreads
+// a correction across the whole cloth in every iteration, so the iteration
+// count stays nearly flat as the cloth is refined.
+class MultigridPreconditioner {
+ public:
+  MultigridPreconditioner(size_t rows, size_t columns);
+
+  size_t GetRows() const {
+    return levels_[0].rows;
+  }
+  size_t GetColumns() const {
+    return levels_[0].columns;
+  }
+  size_t GetSize() const {
+    return levels_[0].rows * levels_[0].columns;
+  }
+  size_t GetLevelCount() const {
+    return levels_.size();
+  }
+
+  // Builds every level's matrix from A, which must have GetSize() rows.
+  // The coarse sparsity patterns are only rebuilt when A's changes.
+  void Setup(const SparseBlockMatrix& A);
+
+  // z = one V-cycle applied to r, starting from zero.
+  void Apply(const std::vector<glm::vec3>& r, std::vector<glm::vec3>& z);
+
+ private:
+  // A level's matrix: the diagonal blocks, and the blocks below the
+  // diagonal in compressed rows (row j holds A_ji for each neighbour
+  // i < j). The blocks above follow by symmetry, so every sweep streams
+  // half the matrix, which is what bounds its speed.
+  struct Level {
+    size_t rows;
+    size_t columns;
+    std::vector<glm::mat3> diagonal;
+    std::vector<glm::mat3> inverse_diagonal;
+    std::vector<int> offsets;
+    std::vector<int> neighbours;
+    std::vector<glm::mat3> blocks;
+    // Interpolation from the next coarser level: up to four coarse nodes
+    // and weights per node, unused ones with weight zero.
+    std::vector<int> parents;
+    std::vector<float> weights;
+    std::vector<glm::vec3> x;
+    std::vector<glm::vec3> b;
+    std::vector<glm::vec3> scratch;
+  };
+
+  void BuildInterpolation(Level& fine, const Level& coarse);
+  void BuildFinePattern(const SparseBlockMatrix& A);
+  void BuildCoarsePattern(const Level& fine, Level& coarse);
+  void ProjectCoarse(const Level& fine, Level& coarse);
+  void FactorCoarsest();
+  void SolveCoarsest();
+  void Cycle(size_t l);
+
+  std::vector<Level> levels_;
+  // Where each off-diagonal block of A lands on the fine level, and
+  // whether transposed (A's block is above the diagonal).
+  std::vector<int> pair_slots_;
+  std::vector<char> pair_transposed_;
+  std::vector<int> pairs_;
+  // Cholesky factor of the coarsest matrix, dense in double, or empty if
+  // it was not positive definite and its block diagonal is used instead.
+  std::vector<double> cholesky_;
+  std::vector<double> dense_rhs_;
+};
+}  // namespace GLOO
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <stdexcept>
+#include <cmath>
+#include <algorithm>
 
 #include <glm/glm.hpp>
 
@@ -27,6 +29,10 @@ struct ParticleState {
     return *this;
   }
 
+  bool operator==(const ParticleState& rhs) const {
+    return positions == rhs.positions && velocities == rhs.velocities;
+  }
+
   ParticleState& operator*=(float k) {
     for (size_t i = 0; i < positions.size(); i++) {
       positions[i] *= k;
@@ -53,6 +59,82 @@ inline ParticleState operator*(float k, ParticleState s1) {
   s1 *= k;
   return s1;
 }
+
+// Fused in-place update out = x + k * y. out may alias x; once out has the
+// size of x this does not allocate, unlike the operators above.
+inline void AddScaled(ParticleState& out,
+                      const ParticleState& x,
+                      float k,
+                      const ParticleState& y) {
+  if (x.positions.size() != y.positions.size() ||
+      x.velocities.size() != y.velocities.size()) {
+    throw std::runtime_error(
+        "Cannot add particle states with inconsistent sizes!");
+  }
+
+  out.positions.resize(x.positions.size());
+  out.velocities.resize(x.velocities.size());
+  for (size_t i = 0; i < x.positions.size(); i++) {
+    out.positions[i] = x.positions[i] + k * y.positions[i];
+  }
+  for (size_t i = 0; i < x.velocities.size(); i++) {
+    out.velocities[i] = x.velocities[i] + k * y.velocities[i];
+  }
+}
+
+// Split updates for symplectic integrators. Kick: velocities += k * the
+// velocity part (accelerations) of derivative. Drift: positions += k *
+// velocities.
+inline void Kick(ParticleState& state, float k, const ParticleState& derivative) {
+  if (state.velocities.size() != derivative.velocities.size()) {
+    throw std::runtime_error(
+        "Cannot add particle states with inconsistent sizes!");
+  }
+  for (size_t i = 0; i < state.velocities.size(); i++) {
+    state.velocities[i] += k * derivative.velocities[i];
+  }
+}
+
+inline void Drift(ParticleState& state, float k) {
+  for (size_t i = 0; i < state.positions.size(); i++) {
+    state.positions[i] += k * state.velocities[i];
+  }
+}
+
+// Largest |error| / (abs_tol + rel_tol * max(|y0|, |y1|)) over all
+// components, for adaptive step control: at most 1 means every component is
+// within tolerance. NaN errors give NaN so that the step is rejected.
+inline float ScaledErrorNorm(const ParticleState& error,
+                             const ParticleState& y0,
+                             const ParticleState& y1,
+                             float abs_tol,
+                             float rel_tol) {
+  float norm = 0.0f;
+  auto accumulate = [&](const glm::vec3& e, const glm::vec3& a,
+                        const glm::vec3& b) {
+    for (int c = 0; c < 3; c++) {
+      float scale =
+          abs_tol + rel_tol * std::max(std::fabs(a[c]), std::fabs(b[c]));
+      norm = std::max(norm, std::fabs(e[c]) / scale);
+      if (std::isnan(e[c])) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (size_t i = 0; i < error.positions.size(); i++) {
+    if (!accumulate(error.positions[i], y0.positions[i], y1.positions[i])) {
+      return NAN;
+    }
+  }
+  for (size_t i = 0; i < error.velocities.size(); i++) {
+    if (!accumulate(error.velocities[i], y0.velocities[i],
+                    y1.velocities[i])) {
+      return NAN;
+    }
+  }
+  return norm;
+}
 }  // namespace GLOO
 
 #endif
@@ -0,0 +1,211 @@
+#ifndef PARTICLE_STATE_SOA_H_
+#define PARTICLE_STATE_SOA_H_
+
+#include <vector>
+#include <stdexcept>
+
+#include <glm/glm.hpp>
+
+#include "AlignedAllocator.hpp"
+#include "SimdKernels.hpp"
+#include "ParticleState.hpp"
+
+namespace GLOO {
+// Structure-of-arrays counterpart of ParticleState. All six components live
+// in one aligned buffer as [px | py | pz | vx | vy | vz], each padded to a
+// multiple of kSimdWidth floats, so whole-state arithmetic is a single
+// streaming SIMD loop. Padding floats are always zero.
+class ParticleStateSoA {
+ public:
+  ParticleStateSoA() : size_(0), stride_(0) {
+  }
+  explicit ParticleStateSoA(const ParticleState& state) : ParticleStateSoA() {
+    FromAoS(state);
+  }
+
+  size_t GetSize() const {
+    return size_;
+  }
+  // Distance in floats between consecutive component arrays.
+  size_t GetStride() const {
+    return stride_;
+  }
+
+  // Resizes to n particles; existing components are not preserved.
+  void Resize(size_t n) {
+    size_t stride = (n + kSimdWidth - 1) / kSimdWidth * kSimdWidth;
+    if (n == size_ && stride == stride_) {
+      return;
+    }
+    size_ = n;
+    stride_ = stride;
+    data_.assign(6 * stride_, 0.0f);
+  }
+
+  float* PositionX() {
+    return Component(0);
+  }
+  float* PositionY() {
+    return Component(1);
+  }
+  float* PositionZ() {
+    return Component(2);
+  }
+  float* VelocityX() {
+    return Component(3);
+  }
+  float* VelocityY() {
+    return Component(4);
+  }
+  float* VelocityZ() {
+    return Component(5);
+  }
+  const float* PositionX() const {
+    return Component(0);
+  }
+  const float* PositionY() const {
+    return Component(1);
+  }
+  const float* PositionZ() const {
+    return Component(2);
+  }
+  const float* VelocityX() const {
+    return Component(3);
+  }
+  const float* VelocityY() const {
+    return Component(4);
+  }
+  const float* VelocityZ() const {
+    return Component(5);
+  }
+  // All six component arrays, including padding.
+  float* Data() {
+    return data_.data();
+  }
+  const float* Data() const {
+    return data_.data();
+  }
+
+  glm::vec3 GetPosition(size_t i) const {
+    return glm::vec3(PositionX()[i], PositionY()[i], PositionZ()[i]);
+  }
+  glm::vec3 GetVelocity(size_t i) const {
+    return glm::vec3(VelocityX()[i], VelocityY()[i], VelocityZ()[i]);
+  }
+  void SetPosition(size_t i, const glm::vec3& p) {
+    PositionX()[i] = p.x;
+    PositionY()[i] = p.y;
+    PositionZ()[i] = p.z;
+  }
+  void SetVelocity(size_t i, const glm::vec3& v) {
+    VelocityX()[i] = v.x;
+    VelocityY()[i] = v.y;
+    VelocityZ()[i] = v.z;
+  }
+
+  void FromAoS(const ParticleState& state) {
+    if (state.positions.size() != state.velocities.size()) {
+      throw std::runtime_error(
+          "Cannot convert a particle state with inconsistent sizes!");
+    }
+    Resize(state.positions.size());
+    for (size_t i = 0; i < size_; i++) {
+      SetPosition(i, state.positions[i]);
+      SetVelocity(i, state.velocities[i]);
+    }
+  }
+
+  void ToAoS(ParticleState& state) const {
+    state.positions.resize(size_);
+    state.velocities.resize(size_);
+    for (size_t i = 0; i < size_; i++) {
+      state.positions[i] = GetPosition(i);
+      state.velocities[i] = GetVelocity(i);
+    }
+  }
+
+  ParticleStateSoA& operator+=(const ParticleStateSoA& rhs) {
+    if (size_ != rhs.size_) {
+      throw std::runtime_error(
+          "Cannot add particle states with inconsistent sizes!");
+    }
+    SimdAxpy(Data(), Data(), 1.0f, rhs.Data(), data_.size());
+    return *this;
+  }
+
+  bool operator==(const ParticleStateSoA& rhs) const {
+    return size_ == rhs.size_ && data_ == rhs.data_;
+  }
+
+  ParticleStateSoA& operator*=(float k) {
+    SimdScale(Data(), k, data_.size());
+    return *this;
+  }
+
+ private:
+  float* Component(size_t c) {
+    return data_.data() + c * stride_;
+  }
+  const float* Component(size_t c) const {
+    return data_.data() + c * stride_;
+  }
+
+  size_t size_;
+  size_t stride_;
+  std::vector<float, AlignedAllocator<float, kSimdAlignment>> data_;
+};
+
+// SoA overload of the fused update used by the integrators: out = x + k * y.
+inline void AddScaled(ParticleStateSoA& out,
+                      const ParticleStateSoA& x,
+                      float k,
+                      const ParticleStateSoA& y) {
+  if (x.GetSize() != y.GetSize()) {
+    throw std::runtime_error(
+        "Cannot add particle states with inconsistent sizes!");
+  }
+  out.Resize(x.GetSize());
+  SimdAxpy(out.Data(), x.Data(), k, y.Data(), 6 * x.GetStride());
+}
+
+// SoA overloads of the symplectic split updates (see ParticleState.hpp). The
+// three position arrays and the three velocity arrays are each contiguous.
+inline void Kick(ParticleStateSoA& state,
+                 float k,
+                 const ParticleStateSoA& derivative) {
+  if (state.GetSize() != derivative.GetSize()) {
+    throw std::runtime_error(
+        "Cannot add particle states with inconsistent sizes!");
+  }
+  SimdAxpy(state.VelocityX(), state.VelocityX(), k, derivative.VelocityX(),
+           3 * state.GetStride());
+}
+
+inline void Drift(ParticleStateSoA& state, float k) {
+  SimdAxpy(state.PositionX(), state.PositionX(), k, state.VelocityX(),
+           3 * state.GetStride());
+}
+
+// SoA overload of the adaptive step error norm (see ParticleState.hpp);
+// padding is zero in every state, so it can be scanned with the data.
+inline float ScaledErrorNorm(const ParticleStateSoA& error,
+                             const ParticleStateSoA& y0,
+                             const ParticleStateSoA& y1,
+                             float abs_tol,
+                             float rel_tol) {
+  const float* e = error.Data();
+  const float* a = y0.Data();
+  const float* b = y1.Data();
+  float norm = 0.0f;
+  for (size_t i = 0; i < 6 * error.GetStride(); i++) {
+    float scale = abs_tol + rel_tol * std::max(std::fabs(a[i]), std::fabs(b[i]));
+    norm = std::max(norm, std::fabs(e[i]) / scale);
+    if (std::isnan(e[i])) {
+      return NAN;
+    }
+  }
+  return norm;
+}
+}  // namespace GLOO
+
+#endif
@@ -1,7 +1,10 @@
 #ifndef PARTICLE_SYSTEM_BASE_H_
 #define PARTICLE_SYSTEM_BASE_H_
 
+#include <vector>
+
 #include "ParticleState.hpp"
+#include "SparseBlockMatrix.hpp"
 
 namespace GLOO {
 class ParticleSystemBase {
@@ -11,6 +14,35 @@ class ParticleSystemBase {
 
   virtual ParticleState ComputeTimeDerivative(const ParticleState& state,
                                               float time) const = 0;
+
+  // Writes the derivative into an existing state so integrators can reuse
+  // their buffers. Systems override this to avoid allocating; the default
+  // falls back to the returning version.
+  virtual void ComputeTimeDerivative(const ParticleState& state,
+                                     float time,
+                                     ParticleState& derivative) const {
+    derivative = ComputeTimeDerivative(state, time);
+  }
+
+  // Linearizes the forces around state for a backward Euler step of dt:
+  // fills lhs = M - dt * df/dv - dt^2 * df/dx and
+  // rhs = dt * (f + dt * df/dx * v), so that lhs * dv = rhs gives each
+  // particle's change in velocity. Returns false if the system has no such
+  // form, in which case implicit integrators iterate on the derivative.
+  virtual bool LinearizeImplicit(const ParticleState& state,
+                                 float time,
+                                 float dt,
+                                 SparseBlockMatrix& lhs,
+                                 std::vector<glm::vec3>& rhs) const {
+    return false;
+  }
+
+  // Systems whose particles form a rows x columns grid, numbered row by
+  // row, report its shape, so that implicit integrators can precondition
+  // with multigrid (see MultigridPreconditioner).
+  virtual bool GetGrid(size_t& rows, size_t& columns) const {
+    return false;
+  }
 };
 }  // namespace GLOO
 
@@ -1,128 +1,97 @@
 #include "PendulumNode.hpp"
 #include "IntegratorFactory.hpp"
-#include "../common/helpers.hpp"
+#include "SystemFactory.hpp"
 
 #include "gloo/components/RenderingComponent.hpp"
 #include "gloo/components/MaterialComponent.hpp"
 #include "gloo/components/ShadingComponent.hpp"
 #include "gloo/shaders/PhongShader.hpp"
+#include "gloo/shaders/InstancedPhongShader.hpp"
 #include "gloo/debug/PrimitiveFactory.hpp"
 #include "gloo/InputManager.hpp"
 
 
 namespace GLOO { 
+namespace {
+const size_t kReplayBytes = size_t(256) << 20;
+const size_t kReplayFrames = 18000; /* five minutes at 60 frames per second */
+}  // namespace
+
 PendulumNode::PendulumNode(ParticleState state, IntegratorType type, float step, bool cloth)
-        : SceneNode() {
-    sphere_mesh_ = PrimitiveFactory::CreateSphere(0.05f, 25, 25);
-    shader_ = std::make_shared<PhongShader>();
-    segments_ = std::make_shared<VertexObject>();
-    reset_ = state;
-    state_ = state;
-    step_ = step;
-    time_ = 0.0;
-    integrator_ = IntegratorFactory::CreateIntegrator<PendulumSystem, ParticleState>(type);
-    system_ = PendulumSystem();
+        : SceneNode(), sphere_instances_(nullptr), reset_requested_(false),
+          replay_clock_(0.0), replaying_(false), replay_frames_back_(0) {
+    Setup(state, type, step);
 
     if (cloth) {
-        InitializeCloth(); /* add cloth to scene */
+        InitializeCloth(ClothDescription()); /* add cloth to scene */
     }
     else {
         InitializePendulum(); /* add pendulum to scene */
     }
 }
 
-void PendulumNode::InitializePendulum() {
-    for (int i = 0; i < state_.positions.size(); i++) {
-        auto sphere = make_unique<SceneNode>();
-        sphere->CreateComponent<RenderingComponent>(sphere_mesh_);
-        
-        auto material_ = std::make_shared<Material>(Material::GetDefault());
-        sphere->CreateComponent<MaterialComponent>(material_);
+PendulumNode::PendulumNode(const ClothDescription& cloth, IntegratorType type, float step)
+        : SceneNode(), sphere_instances_(nullptr), reset_requested_(false),
+          replay_clock_(0.0), replaying_(false), replay_frames_back_(0) {
+    Setup(SystemFactory::CreateClothState(cloth), type, step);
+    InitializeCloth(cloth);
+}
 
-        sphere->CreateComponent<ShadingComponent>(shader_);
+void PendulumNode::Setup(const ParticleState& state, IntegratorType type, float step) {
+    sphere_mesh_ = PrimitiveFactory::CreateSphere(0.05f, 25, 25);
+    shader_ = std::make_shared<PhongShader>();
+    segments_ = std::make_shared<VertexObject>(BufferUsage::Dynamic);
+    reset_ = state;
+    state_ = state;
+    step_ = step;
+    time_ = 0.0;
+    integrator_ = IntegratorFactory::CreateIntegrator<PendulumSystem, ParticleState>(type, state);
+    system_ = PendulumSystem();
+    replay_ = make_unique<ReplayBuffer>(state.positions.size(), kReplayBytes, kReplayFrames);
+}
 
-        spheres_.push_back(sphere.get());
+void PendulumNode::InitializeSpheres() {
+    auto spheres = make_unique<SceneNode>(); /* one node draws every particle in a single call */
+    sphere_instances_ = &spheres->CreateComponent<InstancedRenderingComponent>(sphere_mesh_);
+    sphere_instances_->SetInstanceOffsets(state_.positions);
 
-        system_.AddMass(5.0); /* add sphere to system with mass */
+    auto material_ = std::make_shared<Material>(Material::GetDefault());
+    spheres->CreateComponent<MaterialComponent>(material_);
 
-        AddChild(std::move(sphere));
-    }
-    system_.SetDragConst(1.5);
+    spheres->CreateComponent<ShadingComponent>(std::make_shared<InstancedPhongShader>());
 
-    for (int i = 0; i < state_.positions.size() - 1; i ++) {
-        system_.AddSpring(i, i + 1, 200.0, 0.25);
-    }
-    system_.Fix(0);
-    // system_.Fix(3);
+    AddChild(std::move(spheres));
 }
 
+void PendulumNode::InitializePendulum() {
+    SystemFactory::BuildPendulum(state_, system_);
+    InitializeSpheres();
+}
 
-void PendulumNode::InitializeCloth() { 
-    for (int i = 0; i < state_.positions.size(); i++) {
-        auto sphere = make_unique<SceneNode>();
-        sphere->CreateComponent<RenderingComponent>(sphere_mesh_);
-        
-        auto material_ = std::make_shared<Material>(Material::GetDefault());
-        sphere->CreateComponent<MaterialComponent>(material_);
-
-        sphere->CreateComponent<ShadingComponent>(shader_);
-
-        spheres_.push_back(sphere.get());
-
-        system_.AddMass(5.0); /* add sphere to system with mass */
 
-        AddChild(std::move(sphere));
+void PendulumNode::InitializeCloth(const ClothDescription& cloth) { 
+    SystemFactory::BuildCloth(cloth, system_, collisions_);
+    if (state_.positions.size() > 10000) {
+        sphere_mesh_ = PrimitiveFactory::CreateSphere(cloth.particle_radius, 6, 6); /* keep huge cloths drawable */
     }
-    system_.SetDragConst(70.0);
-    system_.Fix(0);
-    system_.Fix(7); /* fix corners to create draping effect */
-
-    float structural_spring_const = 10000.0;
-    float shear_spring_const = 100.0;
-    float flex_spring_const = 200.0;
-
-    for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
-            if (i != 7) {
-                system_.AddSpring(IndexOf(i, j), IndexOf(i + 1, j), structural_spring_const, 1.0);
-            }
-             if (j != 7) {
-                system_.AddSpring(IndexOf(i, j), IndexOf(i, j + 1), structural_spring_const, 1.0); /* add structural springs */
-            }
-            if (i > 0 && j < 7) {
-                system_.AddSpring(IndexOf(i - 1, j + 1), IndexOf(i, j), shear_spring_const, 1.4);
-            }
-            if (i < 7 && j < 7) {
-                system_.AddSpring(IndexOf(i, j), IndexOf(i + 1, j + 1), shear_spring_const, 1.4); /* add shear springs */
-            }
-            if (i < 6) {
-                system_.AddSpring(IndexOf(i, j), IndexOf(i + 2, j), flex_spring_const, 2.0);
-            }
-             if (j < 6) {
-                system_.AddSpring(IndexOf(i, j), IndexOf(i, j + 2), flex_spring_const, 2.0); /* add flex springs */
-            }
-        }
+    else {
+        sphere_mesh_ = PrimitiveFactory::CreateSphere(cloth.particle_radius, 25, 25);
     }
+    InitializeSpheres();
 
     auto lines = make_unique<SceneNode>(); /* draw lines */
-    auto positions = make_unique<PositionArray>();
     auto indices = make_unique<IndexArray>();
 
-    for (int i = 0; i < system_.Springs.size(); i++) {
-        int index1 = system_.Springs[i].sphere_indices[0];
-        int index2 = system_.Springs[i].sphere_indices[1];
-
-        positions->push_back(state_.positions[index1]);
-        positions->push_back(state_.positions[index2]);
-
-        indices->push_back(positions->size() - 2);
-        indices->push_back(positions->size() - 1);
+    for (size_t i = 0; i < system_.Springs.GetCount(); i++) {
+        indices->push_back(system_.Springs.GetFirst(i)); /* lines index the particles directly */
+        indices->push_back(system_.Springs.GetSecond(i));
     }
-    auto normals = CalculateNormals(*positions, *indices);
+    /* lines have no surface; a fixed normal is uploaded once and lit by the saturated ambient */
+    auto normals = make_unique<NormalArray>(state_.positions.size(), glm::vec3(0, 0, 1));
 
     segments_->UpdateNormals(std::move(normals));
-    segments_->UpdatePositions(std::move(positions));
-    segments_->UpdateIndices(std::move(indices));
+    segments_->UpdatePositions(state_.positions);
+    segments_->UpdateIndices(std::move(indices)); /* topology is uploaded once */
 
     auto material_ = CreateComponent<MaterialComponent>(std::make_shared<Material>());
     material_.GetMaterial().SetAmbientColor(glm::vec3(255, 255, 255));
@@ -137,50 +106,77 @@ void PendulumNode::InitializeCloth() {
     AddChild(std::move(lines));
 }
 
+PendulumNode::~PendulumNode() {
+    simulation_thread_.reset(); /* stop stepping before the state goes away */
+}
+
+void PendulumNode::StartSimulationThread() {
+    simulation_thread_ = make_unique<SimulationThread>(
+        step_, [this](float dt) { Advance(dt); },
+        [this](std::vector<glm::vec3>& positions) { positions = state_.positions; });
+}
+
+void PendulumNode::Advance(float dt) {
+    if (reset_requested_.exchange(false)) {
+        state_ = reset_;
+        islands_.WakeAll(); /* the reset state is not at rest */
+    }
+    islands_.Step(*integrator_, system_, collisions_, state_, time_, dt); /* integrates and resolves contacts */
+    time_ += dt;
+}
+
+void PendulumNode::SetReplay(bool replaying, size_t frames_back) {
+    replaying_ = replaying;
+    replay_frames_back_ = frames_back;
+    if (simulation_thread_ != nullptr) {
+        simulation_thread_->SetPaused(replaying);
+    }
+}
+
 void PendulumNode::Update(double delta_time) {
+    if (replaying_) {
+        size_t count = replay_->GetFrameCount();
+        if (count > 0) {
+            size_t frame = count - 1 - std::min(replay_frames_back_, count - 1);
+            UpdateDrawing(replay_->GetPositions(frame), replay_->GetParticleCount()); /* nothing is re-integrated */
+        }
+        return;
+    }
+
     if (InputManager::GetInstance().IsKeyPressed('R')) {
-        state_ = reset_; /* reset state to initial if R is pressed */
+        reset_requested_ = true; /* applied before the next step */
     }
+    replay_clock_ += delta_time;
+    if (simulation_thread_ != nullptr) {
+        if (simulation_thread_->Interpolate(drawn_positions_)) {
+            UpdateDrawing(drawn_positions_.data(), drawn_positions_.size());
+            replay_->Record(replay_clock_, drawn_positions_);
+        }
+        return;
+    }
+
     double num_steps = delta_time/step_;
-    if (step_ <= delta_time) {
+    if (integrator_->IsAdaptive()) {
+        Advance(delta_time); /* picks its own substeps */
+    }
+    else if (step_ <= delta_time) {
       for (int i = 0; i < num_steps; i++) {
-        state_ = integrator_->Integrate(system_, state_, time_, step_); /* if the step_ is small enough, we can update position a number of times*/
-        for (int j = 0; j < state_.positions.size(); j++) {
-            auto sphere = spheres_[j];
-            sphere->GetTransform().SetPosition(state_.positions[j]);
-        }
-        time_ += step_;
+        Advance(step_); /* if the step_ is small enough, we can update position a number of times*/
       }
     }
     else {
-        state_ = integrator_->Integrate(system_, state_, time_, delta_time);
-        for (int j = 0; j < state_.positions.size(); j++) {
-            auto sphere = spheres_[j];
-            sphere->GetTransform().SetPosition(state_.positions[j]);
-        }
-        time_ += delta_time;
+        Advance(delta_time);
     }
+    UpdateDrawing(state_.positions.data(), state_.positions.size());
+    replay_->Record(replay_clock_, state_.positions);
+}
 
-    auto positions = make_unique<PositionArray>();
-    auto indices = make_unique<IndexArray>();
-
-    for (int i = 0; i < system_.Springs.size(); i++) {
-        int index1 = system_.Springs[i].sphere_indices[0];
-        int index2 = system_.Springs[i].sphere_indices[1];
-
-        positions->push_back(state_.positions[index1]);
-        positions->push_back(state_.positions[index2]);
+void PendulumNode::UpdateDrawing(const glm::vec3* positions, size_t count) {
+    sphere_instances_->StreamInstanceOffsets(positions, count); /* uploaded without a CPU copy */
 
-        indices->push_back(positions->size() - 2);
-        indices->push_back(positions->size() - 1);
+    if (segments_->HasPositions()) {
+        segments_->StreamPositions(positions, count); /* overwritten in place on the GPU */
     }
-    auto normals = CalculateNormals(*positions, *indices);
-
-    segments_->UpdateNormals(std::move(normals));
-    segments_->UpdatePositions(std::move(positions)); /* update the positions and normals of the springs every update */
 }
 
-int PendulumNode::IndexOf(int i, int j) {
-    return j*8 + i; /* returns the correct indices of the spheres we are connecting a spring between */
-}
 }  // namespace GLOO
\ No newline at end of file
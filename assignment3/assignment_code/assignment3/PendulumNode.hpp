@@ -3,25 +3,70 @@
 
 #include "gloo/SceneNode.hpp"
 #include "gloo/VertexObject.hpp"
+#include "gloo/components/InstancedRenderingComponent.hpp"
 #include "gloo/shaders/ShaderProgram.hpp"
 #include "../common/helpers.hpp"
 
 #include "ParticleState.hpp"
 #include "IntegratorBase.hpp"
+#include "IntegratorType.hpp"
 #include "PendulumSystem.hpp"
+#include "CollisionSolver.hpp"
+#include "SimulationDescription.hpp"
+#include "SleepingIslands.hpp"
+#include "SimulationThread.hpp"
+#include "ReplayBuffer.hpp"
+
+#include <atomic>
 
 namespace GLOO {
 class PendulumNode : public SceneNode {
  public:
   PendulumNode(ParticleState state, IntegratorType type, float step, bool cloth);
+  /* a generated cloth; the bool constructor's cloth is the default description */
+  PendulumNode(const ClothDescription& cloth, IntegratorType type, float step);
+  ~PendulumNode();
   void Update(double delta_time) override;  
+  /* moves stepping onto its own thread at the fixed step; Update then only
+     draws positions interpolated between the last two steps */
+  void StartSimulationThread();
+  const IntegratorBase<PendulumSystem, ParticleState>& GetIntegrator() const {
+    return *integrator_;
+  }
+  /* share a pool between nodes; forces are evaluated serially without one */
+  void SetThreadPool(std::shared_ptr<ThreadPool> thread_pool) {
+    collisions_.SetThreadPool(thread_pool);
+    system_.SetThreadPool(std::move(thread_pool));
+  }
+  /* contacts are resolved after every step */
+  CollisionSolver& GetCollisions() {
+    return collisions_;
+  }
+  /* every live frame drawn is recorded. While replaying, the simulation is
+     paused and the recorded frame frames_back before the newest is drawn
+     instead, uploaded straight from the recording */
+  void SetReplay(bool replaying, size_t frames_back);
+  const ReplayBuffer& GetReplay() const {
+    return *replay_;
+  }
+  /* set before the simulation thread starts */
+  void SetForceFields(const ForceFields& fields) {
+    system_.Fields = fields;
+  }
+  /* islands at rest stop being simulated until something hits them */
+  SleepingIslands& GetIslands() {
+    return islands_;
+  }
 
  private:
+  void InitializeSpheres();
   void InitializePendulum();
-  void InitializeCloth();
-  int IndexOf(int i, int j);
+  void Setup(const ParticleState& state, IntegratorType type, float step);
+  void InitializeCloth(const ClothDescription& cloth);
+  void Advance(float dt);
+  void UpdateDrawing(const glm::vec3* positions, size_t count);
 
-  std::vector<SceneNode*> spheres_;
+  InstancedRenderingComponent* sphere_instances_;
   std::shared_ptr<VertexObject> sphere_mesh_;  
   std::shared_ptr<VertexObject> segments_;
   std::shared_ptr<ShaderProgram> shader_;
@@ -33,8 +78,16 @@ class PendulumNode : public SceneNode {
   float time_;
   std::unique_ptr<IntegratorBase<PendulumSystem, ParticleState>> integrator_;
   PendulumSystem system_;
+  CollisionSolver collisions_;
+  SleepingIslands islands_;
+
+  std::atomic<bool> reset_requested_;
+  std::vector<glm::vec3> drawn_positions_;
+  std::unique_ptr<ReplayBuffer> replay_;
+  double replay_clock_;
+  bool replaying_;
+  size_t replay_frames_back_;
+  std::unique_ptr<SimulationThread> simulation_thread_;
 };
 }  // namespace GLOO
-
-#include "PendulumNode.cpp"
 #endif
\ No newline at end of file
@@ -3,7 +3,18 @@
 
 #include "ParticleSystemBase.hpp"
 #include "ParticleState.hpp"
-#include "Spring.hpp"
+#include "ParticleStateSoA.hpp"
+#include "SpringNetwork.hpp"
+#include "SpringColouring.hpp"
+#include "ThreadPool.hpp"
+#include "ForceFields.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
 
 #include "glm/gtx/string_cast.hpp" /* to print vectors, matrices */
 
@@ -12,28 +23,45 @@ class PendulumSystem : public ParticleSystemBase {
   public:
 
   std::vector<float> Masses;
-  std::vector<Spring> Springs;
+  SpringNetwork Springs;
   std::vector<int> Fixed;
   float drag_const;
+  ForceFields Fields; /* wind, vortices, attractors and turbulence on top of gravity and drag */
 
   ParticleState ComputeTimeDerivative(const ParticleState& state, float time) const {
     ParticleState f;
-    std::vector<glm::vec3> Forces; /* temporary vector to keep the total force on each particle */
-    std::vector<glm::vec3> Accelerations; /* temporary vector to keep acceleration of each particle */
+    ComputeTimeDerivative(state, time, f);
+    return f;
+  }
+
+  void ComputeTimeDerivative(const ParticleState& state, float time, ParticleState& f) const {
+    /* forces are accumulated straight into f.velocities and divided by the
+       masses at the end, so nothing is allocated once f has the right size */
+    std::vector<glm::vec3>& Forces = f.velocities;
+    Forces.resize(Masses.size());
 
-    for (int i = 0; i < Masses.size(); i++) { 
+    ForEachParticle(Masses.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
         float w = Masses[i]*9.81;
         glm::vec3 weight = glm::vec3(0, -w, 0); /* gravity acts in y direction only */
         glm::vec3 drag = -drag_const*state.velocities[i]; /* viscous drag force */
-        Forces.push_back(weight + drag);
-    }
+        Forces[i] = weight + drag;
+      }
+      if (!Fields.IsEmpty()) {
+        Fields.AddForces(state.positions.data() + begin, state.velocities.data() + begin,
+                         Masses.data() + begin, time, end - begin, Forces.data() + begin);
+      }
+    });
 
-    for (int i = 0; i < Springs.size(); i++) {
-        int sphere_index1 = Springs[i].sphere_indices[0];
-        int sphere_index2 = Springs[i].sphere_indices[1];
+    const int* spring_indices = Springs.GetIndices();
+    const float* spring_consts = Springs.GetSpringConsts();
+    const float* rest_lengths = Springs.GetRestLengths();
+    ForEachSpring([&](size_t i) {
+        int sphere_index1 = spring_indices[2*i];
+        int sphere_index2 = spring_indices[2*i + 1];
 
-        float spring_const = Springs[i].spring_const;
-        float rest_length = Springs[i].rest_length;
+        float spring_const = spring_consts[i];
+        float rest_length = rest_lengths[i];
 
         glm::vec3 d = state.positions[sphere_index1] - state.positions[sphere_index2];
         float norm_d = glm::length(d);
@@ -48,21 +76,165 @@ class PendulumSystem : public ParticleSystemBase {
 
         Forces[sphere_index1] += spring_force;
         Forces[sphere_index2] -= spring_force;
-    }
+    });
 
     for (int i = 0; i < Fixed.size(); i++) {
         int fixed_index = Fixed[i];
         Forces[fixed_index] = glm::vec3(0, 0, 0); /* fix some spheres so they don't just fall away */
     }
 
-    for (int i = 0; i < Forces.size(); i++) {
-        Accelerations.push_back(Forces[i]/Masses[i]); /* N2L to calculate acceleration */
+    ForEachParticle(Forces.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        Forces[i] = Forces[i]/Masses[i]; /* N2L to calculate acceleration */
+      }
+    });
+
+    f.positions = state.velocities; /* how to compute derivative for pendulum systems */
+  }
+
+  void ComputeTimeDerivative(const ParticleStateSoA& state, float time, ParticleStateSoA& f) const {
+    /* same model as above on separate x/y/z arrays; forces accumulate in
+       f's velocity arrays and become accelerations at the end */
+    size_t n = state.GetSize();
+    f.Resize(n);
+    const float* px = state.PositionX();
+    const float* py = state.PositionY();
+    const float* pz = state.PositionZ();
+    const float* vx = state.VelocityX();
+    const float* vy = state.VelocityY();
+    const float* vz = state.VelocityZ();
+    float* fx = f.VelocityX();
+    float* fy = f.VelocityY();
+    float* fz = f.VelocityZ();
+
+    ForEachParticle(n, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        float w = Masses[i]*9.81;
+        fx[i] = 0 + -drag_const*vx[i]; /* gravity acts in y direction only */
+        fy[i] = -w + -drag_const*vy[i];
+        fz[i] = 0 + -drag_const*vz[i];
+      }
+      if (!Fields.IsEmpty()) {
+        Fields.AddForces(px + begin, py + begin, pz + begin, vx + begin, vy + begin, vz + begin,
+                         Masses.data() + begin, time, end - begin, fx + begin, fy + begin, fz + begin);
+      }
+    });
+
+    const int* spring_indices = Springs.GetIndices();
+    const float* spring_consts = Springs.GetSpringConsts();
+    const float* rest_lengths = Springs.GetRestLengths();
+    ForEachSpring([&](size_t i) {
+        int a = spring_indices[2*i];
+        int b = spring_indices[2*i + 1];
+
+        float dx = px[a] - px[b];
+        float dy = py[a] - py[b];
+        float dz = pz[a] - pz[b];
+        float norm_d = std::sqrt(dx*dx + dy*dy + dz*dz);
+        if (norm_d == 0) {
+            return;
+        }
+        float k = -spring_consts[i]*(norm_d - rest_lengths[i]);
+        float sx = k*(dx/norm_d);
+        float sy = k*(dy/norm_d);
+        float sz = k*(dz/norm_d);
+
+        fx[a] += sx;
+        fy[a] += sy;
+        fz[a] += sz;
+        fx[b] -= sx;
+        fy[b] -= sy;
+        fz[b] -= sz;
+    });
+
+    for (size_t i = 0; i < Fixed.size(); i++) {
+        fx[Fixed[i]] = fy[Fixed[i]] = fz[Fixed[i]] = 0; /* fixed spheres feel no force */
     }
 
-    f.positions = state.velocities;
-    f.velocities = Accelerations; /* how to compute derivative for pendulum systems */
-    
-    return f;
+    ForEachParticle(n, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        fx[i] = fx[i]/Masses[i]; /* N2L to calculate acceleration */
+        fy[i] = fy[i]/Masses[i];
+        fz[i] = fz[i]/Masses[i];
+      }
+    });
+
+    /* position derivative is the velocity */
+    std::copy(vx, vx + 3 * state.GetStride(), f.PositionX());
+  }
+
+  bool LinearizeImplicit(const ParticleState& state,
+                         float time,
+                         float dt,
+                         SparseBlockMatrix& lhs,
+                         std::vector<glm::vec3>& rhs) const override {
+    /* one stiffness block per spring, so the matrix pattern is the spring
+       network itself; drag only adds to the diagonal */
+    size_t n = Masses.size();
+    lhs.SetStructure(n, Springs.GetIndices(), Springs.GetCount());
+    rhs.resize(n);
+
+    ForEachParticle(n, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        glm::vec3 weight = glm::vec3(0, -Masses[i]*9.81f, 0);
+        glm::vec3 drag = -drag_const*state.velocities[i];
+        rhs[i] = weight + drag;
+        lhs.Diagonal(i) = glm::mat3(Masses[i] + dt*(drag_const + Fields.GetDrag())); /* df/dv = -(drag_const + field drag) */
+      }
+      if (!Fields.IsEmpty()) {
+        /* the fields' dependence on position is left explicit */
+        Fields.AddForces(state.positions.data() + begin, state.velocities.data() + begin,
+                         Masses.data() + begin, time, end - begin, rhs.data() + begin);
+      }
+      for (size_t i = begin; i < end; i++) {
+        rhs[i] = dt*rhs[i];
+      }
+    });
+
+    const int* spring_indices = Springs.GetIndices();
+    const float* spring_consts = Springs.GetSpringConsts();
+    const float* rest_lengths = Springs.GetRestLengths();
+    ForEachSpring([&](size_t i) {
+        int a = spring_indices[2*i];
+        int b = spring_indices[2*i + 1];
+
+        glm::vec3 d = state.positions[a] - state.positions[b];
+        float norm_d = glm::length(d);
+        if (norm_d == 0) {
+            return;
+        }
+        glm::vec3 dir = d/norm_d;
+        glm::vec3 spring_force = -spring_consts[i]*(norm_d - rest_lengths[i])*dir;
+
+        /* df_a/dx_a = -stiffness. The transverse term is dropped for
+           compressed springs, where it would make the matrix indefinite */
+        glm::mat3 outer = glm::outerProduct(dir, dir);
+        float transverse = std::max(0.0f, 1 - rest_lengths[i]/norm_d);
+        glm::mat3 stiffness = spring_consts[i]*(outer + transverse*(glm::mat3(1.0f) - outer));
+
+        glm::vec3 impulse = dt*(spring_force - dt*(stiffness*(state.velocities[a] - state.velocities[b])));
+        rhs[a] += impulse;
+        rhs[b] -= impulse;
+        lhs.Diagonal(a) += dt*dt*stiffness;
+        lhs.Diagonal(b) += dt*dt*stiffness;
+        lhs.OffDiagonal(i) = -dt*dt*stiffness;
+    });
+
+    if (!Fixed.empty()) {
+        /* fixed spheres get dv = 0 and are decoupled from their neighbours */
+        fixed_mask_.assign(n, 0);
+        for (size_t i = 0; i < Fixed.size(); i++) {
+            fixed_mask_[Fixed[i]] = 1;
+            lhs.Diagonal(Fixed[i]) = glm::mat3(1.0f);
+            rhs[Fixed[i]] = glm::vec3(0, 0, 0);
+        }
+        for (size_t k = 0; k < lhs.GetBlockCount(); k++) {
+            if (fixed_mask_[lhs.GetRow(k)] || fixed_mask_[lhs.GetColumn(k)]) {
+                lhs.OffDiagonal(k) = glm::mat3(0.0f);
+            }
+        }
+    }
+    return true;
   }
 
   void AddMass(float mass) { 
@@ -70,11 +242,20 @@ class PendulumSystem : public ParticleSystemBase {
   }
 
   void AddSpring(int sphere_index1, int sphere_index2, float spring_const, float rest_length) {
-    auto spring = make_unique<Spring>();
-    spring->sphere_indices = {sphere_index1, sphere_index2};
-    spring->spring_const = spring_const;
-    spring->rest_length = rest_length;
-    Springs.push_back(*spring);
+    Springs.Add(sphere_index1, sphere_index2, spring_const, rest_length);
+  }
+
+  /* replaces all springs, e.g. with a network from SpringNetwork::Load;
+     every endpoint must be one of the particles already added */
+  void SetSprings(SpringNetwork springs) {
+    for (size_t i = 0; i < springs.GetCount(); i++) {
+      if (size_t(springs.GetSecond(i)) >= Masses.size()) { /* the larger endpoint */
+        throw std::runtime_error("Cannot attach a spring to particle " +
+                                 std::to_string(springs.GetSecond(i)) + " of " +
+                                 std::to_string(Masses.size()) + "!");
+      }
+    }
+    Springs = std::move(springs);
   }
 
   void Fix(int i) { 
@@ -84,6 +265,75 @@ class PendulumSystem : public ParticleSystemBase {
   void SetDragConst(float drag) {
     drag_const = drag;
   }
+
+  /* the particles form a rows x columns grid, numbered row by row, as
+     cloths do, which lets implicit integrators precondition with multigrid */
+  void SetGrid(size_t rows, size_t columns) {
+    grid_rows_ = rows;
+    grid_columns_ = columns;
+  }
+  bool GetGrid(size_t& rows, size_t& columns) const override {
+    if (grid_rows_ * grid_columns_ == 0 || grid_rows_ * grid_columns_ != Masses.size()) {
+      return false; /* no grid, or particles added since */
+    }
+    rows = grid_rows_;
+    columns = grid_columns_;
+    return true;
+  }
+
+  /* Evaluates forces on the pool's threads (nullptr evaluates serially).
+     Springs are split into colours whose springs share no particle, so
+     they scatter forces without locks; colours run in a fixed order, so
+     any pool gives the same result whatever its size. Serial evaluation
+     adds springs in spring order instead, which can differ from a pool's
+     result in the last bits. */
+  void SetThreadPool(std::shared_ptr<ThreadPool> thread_pool) {
+    thread_pool_ = std::move(thread_pool);
+  }
+  const std::shared_ptr<ThreadPool>& GetThreadPool() const {
+    return thread_pool_;
+  }
+
+  private:
+  template <class TKernel>
+  void ForEachParticle(size_t count, const TKernel& kernel) const {
+    if (thread_pool_ == nullptr) {
+      kernel(0, count);
+    } else {
+      thread_pool_->ParallelFor(count, 4096, std::cref(kernel));
+    }
+  }
+
+  template <class TKernel>
+  void ForEachSpring(const TKernel& kernel) const {
+    if (thread_pool_ == nullptr) {
+      for (size_t i = 0; i < Springs.GetCount(); i++) {
+        kernel(i);
+      }
+      return;
+    }
+
+    if (colouring_revision_ != Springs.GetRevision()) {
+      colouring_ = SpringColouring(Springs); /* springs changed since the last colouring */
+      colouring_revision_ = Springs.GetRevision();
+    }
+    for (size_t c = 0; c < colouring_.GetColourCount(); c++) {
+      const uint32_t* springs = colouring_.GetSprings(c);
+      auto chunk = [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+          kernel(springs[k]);
+        }
+      };
+      thread_pool_->ParallelFor(colouring_.GetSize(c), 1024, std::cref(chunk));
+    }
+  }
+
+  std::shared_ptr<ThreadPool> thread_pool_;
+  size_t grid_rows_ = 0;
+  size_t grid_columns_ = 0;
+  mutable SpringColouring colouring_;
+  mutable size_t colouring_revision_ = size_t(-1);
+  mutable std::vector<char> fixed_mask_;
 };
 } // namespace GLOO
 #endif
\ No newline at end of file
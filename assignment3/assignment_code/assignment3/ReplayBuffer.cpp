@@ -0,0 +1,48 @@
+#include "ReplayBuffer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace GLOO {
+ReplayBuffer::ReplayBuffer(size_t particle_count,
+                           size_t byte_budget,
+                           size_t max_frames)
+    : particle_count_(particle_count), oldest_(0), frame_count_(0) {
+  size_t frame_bytes = std::max<size_t>(1, particle_count * sizeof(glm::vec3));
+  capacity_ = std::max<size_t>(
+      1, std::min(max_frames, byte_budget / frame_bytes));
+}
+
+void ReplayBuffer::Record(float time, const std::vector<glm::vec3>& positions) {
+  if (positions.size() != particle_count_) {
+    throw std::runtime_error("Cannot record " +
+                             std::to_string(positions.size()) +
+                             " positions into a replay of " +
+                             std::to_string(particle_count_) + "!");
+  }
+  size_t slot;
+  if (frame_count_ < capacity_) {
+    slot = Slot(frame_count_++);
+  } else {
+    slot = oldest_; /* full: the newest frame replaces the oldest */
+    oldest_ = (oldest_ + 1) % capacity_;
+  }
+  if (slot >= times_.size()) {
+    /* grow by doubling, but never past the capacity */
+    size_t frames = std::min(capacity_, std::max<size_t>(2 * times_.size(), 64));
+    positions_.reserve(frames * particle_count_);
+    times_.reserve(frames);
+    positions_.resize((slot + 1) * particle_count_);
+    times_.resize(slot + 1);
+  }
+  std::copy(positions.begin(), positions.end(),
+            positions_.begin() + slot * particle_count_);
+  times_[slot] = time;
+}
+
+void ReplayBuffer::Clear() {
+  oldest_ = 0;
+  frame_count_ = 0;
+}
+}  // namespace GLOO
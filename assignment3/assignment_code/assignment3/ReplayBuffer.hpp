@@ -0,0 +1,57 @@
+#ifndef REPLAY_BUFFER_H_
+#define REPLAY_BUFFER_H_
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace GLOO {
+// The last frames of a simulation, for scrubbing back through a run without
+// re-integrating it. Frames are the positions of every particle, kept in
+// one ring that grows with the frames recorded, up to its capacity; once
+// full each new frame overwrites the oldest, so recording stops
+// allocating. A stored frame is contiguous, so it can be uploaded to the
+// GPU straight from the ring.
+class ReplayBuffer {
+ public:
+  // Capacity for as many frames of particle_count particles as fit in
+  // byte_budget, but at most max_frames. Nothing is allocated until frames
+  // are recorded.
+  ReplayBuffer(size_t particle_count, size_t byte_budget, size_t max_frames);
+
+  void Record(float time, const std::vector<glm::vec3>& positions);
+  void Clear();
+
+  size_t GetParticleCount() const {
+    return particle_count_;
+  }
+  size_t GetCapacity() const {
+    return capacity_;
+  }
+  size_t GetFrameCount() const {
+    return frame_count_;
+  }
+  // Frame 0 is the oldest kept. Points into the ring, so it is valid until
+  // the next Record.
+  const glm::vec3* GetPositions(size_t frame) const {
+    return &positions_[Slot(frame) * particle_count_];
+  }
+  float GetTime(size_t frame) const {
+    return times_[Slot(frame)];
+  }
+
+ private:
+  size_t Slot(size_t frame) const {
+    return (oldest_ + frame) % capacity_;
+  }
+
+  size_t particle_count_;
+  size_t capacity_;
+  std::vector<glm::vec3> positions_;
+  std::vector<float> times_;
+  size_t oldest_;
+  size_t frame_count_;
+};
+}  // namespace GLOO
+
+#endif
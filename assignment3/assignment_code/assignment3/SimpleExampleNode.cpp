@@ -13,10 +13,14 @@ SimpleExampleNode::SimpleExampleNode(ParticleState state, IntegratorType type, f
     sphere_mesh_ = PrimitiveFactory::CreateSphere(0.05f, 25, 25);
     shader_ = std::make_shared<PhongShader>();
 
-    state_ = state;
+    state_ = MakeFixedState<1>(state);
     step_ = step;
     time_ = 0.0;
-    integrator_ = IntegratorFactory::CreateIntegrator<CircleBase, ParticleState>(type);
+    if (type == IntegratorType::SymplecticEuler || type == IntegratorType::VelocityVerlet ||
+        type == IntegratorType::Xpbd) {
+        type = IntegratorType::RK4; /* the circle is first order, with no velocities or springs */
+    }
+    integrator_ = IntegratorFactory::CreateIntegrator<CircleBase, FixedParticleState<1>>(type, state_);
     system_ = CircleBase();
 
     InitializeSphere(); /* add sphere to scene */
@@ -37,15 +41,20 @@ void SimpleExampleNode::InitializeSphere() {
 
 void SimpleExampleNode::Update(double delta_time) {
     double num_steps = delta_time/step_;
-    if (step_ <= delta_time) {
+    if (integrator_->IsAdaptive()) {
+        integrator_->Step(system_, state_, time_, delta_time); /* picks its own substeps */
+        sphere_node_->GetTransform().SetPosition(state_.positions[0]);
+        time_ += float(delta_time);
+    }
+    else if (step_ <= delta_time) {
       for (int i = 0; i < num_steps; i++) {
-         state_ = integrator_->Integrate(system_, state_, time_, step_); /* if the step_ is small enough, we can update position a number of times*/
+         integrator_->Step(system_, state_, time_, step_); /* if the step_ is small enough, we can update position a number of times*/
          sphere_node_->GetTransform().SetPosition(state_.positions[0]);
          time_ += step_;
       }
     }
     else {
-        state_ = integrator_->Integrate(system_, state_, time_, delta_time);
+        integrator_->Step(system_, state_, time_, delta_time);
         sphere_node_->GetTransform().SetPosition(state_.positions[0]);
         time_ += float(delta_time);
     }
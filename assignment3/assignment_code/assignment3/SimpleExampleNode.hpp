@@ -6,7 +6,9 @@
 #include "gloo/shaders/ShaderProgram.hpp"
 
 #include "ParticleState.hpp"
+#include "FixedParticleState.hpp"
 #include "IntegratorBase.hpp"
+#include "IntegratorType.hpp"
 #include "CircleBase.hpp"
 
 namespace GLOO {
@@ -22,13 +24,11 @@ class SimpleExampleNode : public SceneNode {
   std::shared_ptr<VertexObject> sphere_mesh_;  
   std::shared_ptr<ShaderProgram> shader_;
 
-  ParticleState state_;
+  FixedParticleState<1> state_; /* one particle, so steps never allocate */
   float step_;
   float time_;
-  std::unique_ptr<IntegratorBase<CircleBase, ParticleState>> integrator_;
+  std::unique_ptr<IntegratorBase<CircleBase, FixedParticleState<1>>> integrator_;
   CircleBase system_;
 };
 }  // namespace GLOO
-
-#include "SimpleExampleNode.cpp"
 #endif
\ No newline at end of file
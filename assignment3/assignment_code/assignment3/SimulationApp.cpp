@@ -1,6 +1,11 @@
 #include "SimulationApp.hpp"
 #include "SimpleExampleNode.hpp"
 #include "PendulumNode.hpp"
+#include "SystemFactory.hpp"
+
+#include <algorithm>
+
+#include "gloo/external.hpp"
 
 #include "glm/gtx/string_cast.hpp"
 
@@ -21,10 +26,21 @@ namespace GLOO {
 SimulationApp::SimulationApp(const std::string& app_name,
                              glm::ivec2 window_size,
                              IntegratorType integrator_type,
-                             float integration_step)
+                             float integration_step,
+                             size_t thread_count,
+                             bool async)
     : Application(app_name, window_size),
       integrator_type_(integrator_type),
-      integration_step_(integration_step) {
+      integration_step_(integration_step),
+      thread_count_(thread_count),
+      async_(async),
+      sleep_energy_(0.0f),
+      sleep_delay_(0.0f),
+      replaying_(false),
+      replay_playing_(false),
+      replay_frame_(0),
+      pendulum_node_ptr_(nullptr),
+      cloth_node_ptr_(nullptr) {
 }
 
 void SimulationApp::SetupScene() {
@@ -60,32 +76,78 @@ void SimulationApp::SetupScene() {
 
   // Pendulum set up
   
-  auto pendulum_state = ParticleState();
-
-  std::vector<glm::vec3> pendulum_positions_ = {glm::vec3(0.5, 0.0, 0), glm::vec3(1.0, 0.0, 0), glm::vec3(1.5, 0.0, 0), glm::vec3(2.0, 0.0, 0)};
-  std::vector<glm::vec3> pendulum_velocities_ = {glm::vec3(0, 0, 0), glm::vec3(0, 0, 0), glm::vec3(0, 0, 0), glm::vec3(0, 0, 0)};
-
-  pendulum_state.positions = pendulum_positions_;
-  pendulum_state.velocities = pendulum_velocities_;
+  auto pendulum_state = SystemFactory::CreatePendulumState();
 
   auto pendulum = make_unique<PendulumNode>(pendulum_state, integrator_type_, integration_step_, false);
+  pendulum_node_ptr_ = pendulum.get();
   root.AddChild(std::move(pendulum)); /* add pendulum to scene */
 
   // Cloth set up
   
-  auto cloth_state = ParticleState();
-  glm::vec3 origin = glm::vec3(-8.0, 0, 0);
-
-  for (int i = 0; i < 8; i++) {
-    for (int j = 0; j < 8; j++) {
-      glm::vec3 offset = origin + glm::vec3(j*1.0, 0, 0) + glm::vec3(0, -i*1.0, 0);
-      cloth_state.positions.push_back(offset);
-      cloth_state.velocities.push_back(glm::vec3(0, 0, 0));
-    }
+  auto cloth = make_unique<PendulumNode>(cloth_, integrator_type_, integration_step_);
+  if (thread_count_ != 1) {
+    cloth->SetThreadPool(std::make_shared<ThreadPool>(thread_count_)); /* 0 uses every core */
   }
-
-  auto cloth = make_unique<PendulumNode>(cloth_state, integrator_type_, integration_step_, true);
+  cloth_node_ptr_ = cloth.get();
   root.AddChild(std::move(cloth)); /* add cloth to scene */
 
+  pendulum_node_ptr_->SetForceFields(fields_);
+  cloth_node_ptr_->SetForceFields(fields_);
+  pendulum_node_ptr_->GetIslands().SetSleepThreshold(sleep_energy_, sleep_delay_);
+  cloth_node_ptr_->GetIslands().SetSleepThreshold(sleep_energy_, sleep_delay_);
+
+  if (async_) {
+    pendulum_node_ptr_->StartSimulationThread();
+    cloth_node_ptr_->StartSimulationThread();
+  }
+
+}
+
+void SimulationApp::DrawGUI() {
+  DrawReplayGUI();
+  if (integrator_type_ != IntegratorType::RK45 || async_) {
+    /* the counters belong to the simulation thread when running async */
+    return;
+  }
+  ImGui::Begin("Adaptive Steps");
+  ImGui::Text("Pendulum: %zu accepted, %zu rejected",
+              pendulum_node_ptr_->GetIntegrator().GetAcceptedSteps(),
+              pendulum_node_ptr_->GetIntegrator().GetRejectedSteps());
+  ImGui::Text("Cloth: %zu accepted, %zu rejected",
+              cloth_node_ptr_->GetIntegrator().GetAcceptedSteps(),
+              cloth_node_ptr_->GetIntegrator().GetRejectedSteps());
+  ImGui::End();
+}
+
+void SimulationApp::DrawReplayGUI() {
+  const ReplayBuffer& recording = cloth_node_ptr_->GetReplay();
+  int frame_count = int(std::max(recording.GetFrameCount(),
+                                 pendulum_node_ptr_->GetReplay().GetFrameCount()));
+  ImGui::Begin("Replay");
+  if (ImGui::Checkbox("Replay", &replaying_) && !replaying_) {
+    replay_playing_ = false;
+    replay_frame_ = 0; /* back to live */
+  }
+  if (replaying_) {
+    if (replay_playing_ && replay_frame_ < 0) {
+      replay_frame_++; /* one recorded frame per frame drawn */
+    } else {
+      replay_playing_ = false;
+    }
+    if (ImGui::Button(replay_playing_ ? "Pause" : "Play")) {
+      replay_playing_ = !replay_playing_;
+    }
+    ImGui::SameLine();
+    ImGui::SliderInt("Frame", &replay_frame_, std::min(0, 1 - frame_count), 0);
+    size_t shown = size_t(std::max(0, frame_count - 1 + replay_frame_));
+    if (shown < recording.GetFrameCount()) {
+      ImGui::Text("t = %.2f s", recording.GetTime(shown));
+    }
+  }
+  ImGui::Text("%d of %zu frames recorded", frame_count, recording.GetCapacity());
+  ImGui::End();
+
+  pendulum_node_ptr_->SetReplay(replaying_, size_t(-replay_frame_));
+  cloth_node_ptr_->SetReplay(replaying_, size_t(-replay_frame_));
 }
 }  // namespace GLOO
@@ -5,6 +5,8 @@
 
 #include "IntegratorType.hpp"
 #include "ParticleState.hpp"
+#include "PendulumNode.hpp"
+#include "SimulationDescription.hpp"
 
 namespace GLOO {
 class SimulationApp : public Application {
@@ -12,12 +14,43 @@ class SimulationApp : public Application {
   SimulationApp(const std::string& app_name,
                 glm::ivec2 window_size,
                 IntegratorType integrator_type,
-                float integration_step);
+                float integration_step,
+                size_t thread_count = 1,
+                bool async = false);
   void SetupScene() override;
+  /* the cloth built by SetupScene; the default is the original 8x8 cloth */
+  void SetClothDescription(const ClothDescription& cloth) {
+    cloth_ = cloth;
+  }
+  /* wind and other fields acting on the pendulum and cloth */
+  void SetForceFields(const ForceFields& fields) {
+    fields_ = fields;
+  }
+  /* lets the pendulum and cloth sleep once at rest; see SleepingIslands */
+  void SetSleepThreshold(float energy_per_mass, float delay) {
+    sleep_energy_ = energy_per_mass;
+    sleep_delay_ = delay;
+  }
+
+ protected:
+  void DrawGUI() override;
 
  private:
+  void DrawReplayGUI();
+
   IntegratorType integrator_type_;
   float integration_step_;
+  size_t thread_count_;
+  bool async_;
+  ClothDescription cloth_;
+  float sleep_energy_;
+  float sleep_delay_;
+  ForceFields fields_;
+  bool replaying_;
+  bool replay_playing_;
+  int replay_frame_; /* frames back from the newest, negated for the slider */
+  PendulumNode* pendulum_node_ptr_;
+  PendulumNode* cloth_node_ptr_;
 
 };
 }  // namespace GLOO
@@ -0,0 +1,135 @@
+#include "SimulationDescription.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace GLOO {
+SimulationDescription SimulationDescription::Load(
+    const std::string& file_path) {
+  std::ifstream fs(file_path);
+  if (!fs) {
+    throw std::runtime_error("Cannot load " + file_path + "!");
+  }
+
+  SimulationDescription description;
+  ClothDescription& cloth = description.cloth;
+  bool default_pins = true;
+  std::string line;
+  size_t line_number = 0;
+  while (std::getline(fs, line)) {
+    line_number++;
+    std::istringstream ss(line);
+    std::string key;
+    if (!(ss >> key) || key[0] == '#') {
+      continue;
+    }
+    bool parsed;
+    if (key == "grid") {
+      parsed = bool(ss >> cloth.width >> cloth.height);
+    } else if (key == "spacing") {
+      parsed = bool(ss >> cloth.spacing);
+    } else if (key == "origin") {
+      parsed = bool(ss >> cloth.origin.x >> cloth.origin.y >> cloth.origin.z);
+    } else if (key == "mass") {
+      parsed = bool(ss >> cloth.mass);
+    } else if (key == "drag") {
+      parsed = bool(ss >> cloth.drag_const);
+    } else if (key == "structural") {
+      parsed = bool(ss >> cloth.structural.spring_const >>
+                    cloth.structural.rest_ratio);
+    } else if (key == "shear") {
+      parsed = bool(ss >> cloth.shear.spring_const >> cloth.shear.rest_ratio);
+    } else if (key == "flex") {
+      parsed = bool(ss >> cloth.flex.spring_const >> cloth.flex.rest_ratio);
+    } else if (key == "pin") {
+      if (default_pins) {
+        cloth.pins.clear();
+        default_pins = false;
+      }
+      glm::ivec2 pin;
+      parsed = bool(ss >> pin.x >> pin.y);
+      cloth.pins.push_back(pin);
+    } else if (key == "springs") {
+      parsed = bool(ss >> cloth.springs_file);
+      size_t slash = file_path.find_last_of('/');
+      if (parsed && cloth.springs_file[0] != '/' &&
+          slash != std::string::npos) {
+        cloth.springs_file = file_path.substr(0, slash + 1) + cloth.springs_file;
+      }
+    } else if (key == "radius") {
+      parsed = bool(ss >> cloth.particle_radius);
+    } else if (key == "self_collision") {
+      parsed = bool(ss >> cloth.self_collision);
+    } else if (key == "floor") {
+      std::string value;
+      parsed = bool(ss >> value);
+      cloth.floor = value != "off";
+      if (parsed && cloth.floor) {
+        cloth.floor_height = std::stof(value);
+      }
+    } else if (key == "integrator") {
+      std::string value;
+      parsed = bool(ss >> value);
+      if (parsed) {
+        description.integrator = ParseIntegratorType(value[0]);
+      }
+    } else if (key == "step") {
+      parsed = bool(ss >> description.step);
+    } else if (key == "sleep") {
+      parsed = bool(ss >> description.sleep_energy >> description.sleep_delay);
+    } else if (key == "wind") {
+      WindField wind;
+      glm::vec3& v = wind.velocity;
+      parsed = bool(ss >> v.x >> v.y >> v.z >> wind.drag);
+      if (parsed && ss >> wind.gust) {
+        parsed = bool(ss >> wind.gust_frequency);
+      }
+      if (parsed) {
+        description.fields.AddWind(wind);
+      }
+    } else if (key == "vortex") {
+      VortexField vortex;
+      glm::vec3& c = vortex.center;
+      glm::vec3& a = vortex.axis;
+      parsed = bool(ss >> c.x >> c.y >> c.z >> a.x >> a.y >> a.z >>
+                    vortex.speed >> vortex.core_radius >> vortex.drag);
+      if (parsed) {
+        description.fields.AddVortex(vortex);
+      }
+    } else if (key == "attractor") {
+      AttractorField attractor;
+      glm::vec3& c = attractor.center;
+      parsed = bool(ss >> c.x >> c.y >> c.z >> attractor.strength >>
+                    attractor.softening);
+      if (parsed) {
+        description.fields.AddAttractor(attractor);
+      }
+    } else if (key == "turbulence") {
+      TurbulenceField turbulence;
+      parsed = bool(ss >> turbulence.speed >> turbulence.length_scale >>
+                    turbulence.drag);
+      ss >> turbulence.seed;
+      if (parsed) {
+        description.fields.AddTurbulence(turbulence);
+      }
+    } else {
+      throw std::runtime_error("Unknown setting " + key + " on line " +
+                               std::to_string(line_number) + " of " +
+                               file_path + "!");
+    }
+    if (!parsed) {
+      throw std::runtime_error("Malformed " + key + " on line " +
+                               std::to_string(line_number) + " of " +
+                               file_path + "!");
+    }
+  }
+
+  if (cloth.width < 1 || cloth.height < 1) {
+    throw std::runtime_error("Cannot build a cloth of " +
+                             std::to_string(cloth.width) + "x" +
+                             std::to_string(cloth.height) + " particles!");
+  }
+  return description;
+}
+}  // namespace GLOO
@@ -0,0 +1,75 @@
+#ifndef SIMULATION_DESCRIPTION_H_
+#define SIMULATION_DESCRIPTION_H_
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ForceFields.hpp"
+#include "IntegratorType.hpp"
+
+namespace GLOO {
+// Stiffness of one kind of cloth spring, with its rest length in units of
+// the grid spacing.
+struct ClothSpringType {
+  float spring_const;
+  float rest_ratio;
+};
+
+// A rectangular cloth of width x height particles hanging in the xy plane,
+// row 0 at the top. The defaults are the viewer's original 8x8 cloth.
+struct ClothDescription {
+  int width = 8;
+  int height = 8;
+  float spacing = 1.0f;
+  glm::vec3 origin = glm::vec3(-8.0f, 0.0f, 0.0f);  // Particle (0, 0).
+  float mass = 5.0f;                                // Per particle.
+  float drag_const = 70.0f;
+  ClothSpringType structural = {10000.0f, 1.0f};  // To the 4 neighbours.
+  ClothSpringType shear = {100.0f, 1.4f};         // To the 4 diagonals.
+  ClothSpringType flex = {200.0f, 2.0f};          // Two along each axis.
+  // Pinned particles as (column, row); negative values count from the last
+  // column or row, so (-1, 0) is the top right corner at any size.
+  std::vector<glm::ivec2> pins = {glm::ivec2(0, 0), glm::ivec2(-1, 0)};
+  float particle_radius = 0.05f;
+  bool self_collision = true;
+  bool floor = true;
+  float floor_height = -9.0f;
+  // A SpringNetwork file replacing the generated springs, if not empty.
+  std::string springs_file;
+
+  int IndexOf(int column, int row) const {
+    return row * width + column;
+  }
+};
+
+// A cloth and how to step it. Text format, one setting per line, '#' for
+// comments; settings left out keep their defaults:
+//   grid <width> <height>          spacing <s>
+//   origin <x> <y> <z>             mass <m>          drag <d>
+//   structural <k> <rest_ratio>    shear <k> <rest_ratio>
+//   flex <k> <rest_ratio>          pin <column> <row>   (replaces defaults)
+//   radius <r>    self_collision <0|1>    floor <height|off>
+//   springs <file>   (a SpringNetwork, relative to this file; replaces
+//                     the generated springs)
+//   integrator <e|t|r|i|a|s|v|x>   step <seconds>
+//   sleep <energy_per_mass> <delay>   (see SleepingIslands; 0 never sleeps)
+// and any number of force fields (see ForceFields):
+//   wind <vx> <vy> <vz> <drag> [<gust> <gust_frequency>]
+//   vortex <cx> <cy> <cz> <ax> <ay> <az> <speed> <core_radius> <drag>
+//   attractor <cx> <cy> <cz> <strength> <softening>
+//   turbulence <speed> <length_scale> <drag> [<seed>]
+struct SimulationDescription {
+  ClothDescription cloth;
+  IntegratorType integrator = IntegratorType::RK4;
+  float step = 0.005f;
+  float sleep_energy = 0.0f;
+  float sleep_delay = 0.5f;
+  ForceFields fields;
+
+  static SimulationDescription Load(const std::string& file_path);
+};
+}  // namespace GLOO
+
+#endif
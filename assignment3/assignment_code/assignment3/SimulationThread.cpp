@@ -0,0 +1,85 @@
+#include "SimulationThread.hpp"
+
+#include <algorithm>
+
+namespace GLOO {
+constexpr double SimulationThread::kMaxLag;
+
+SimulationThread::SimulationThread(
+    float step,
+    std::function<void(float)> advance,
+    std::function<void(std::vector<glm::vec3>&)> read_positions)
+    : step_(step),
+      advance_(std::move(advance)),
+      read_positions_(std::move(read_positions)),
+      stopping_(false),
+      paused_(false),
+      step_count_(0) {
+  thread_ = std::thread(&SimulationThread::Run, this);
+}
+
+SimulationThread::~SimulationThread() {
+  stopping_ = true;
+  thread_.join();
+}
+
+bool SimulationThread::Interpolate(std::vector<glm::vec3>& positions) {
+  frames_.Update();
+  const Frame& frame = frames_.GetReadBuffer();
+  if (!frame.valid) {
+    return false;
+  }
+  double since_published =
+      std::chrono::duration<double>(Clock::now() - frame.published).count();
+  float alpha = float(
+      std::min(1.0, std::max(0.0, (frame.leftover + since_published) / step_)));
+  positions.resize(frame.current.size());
+  for (size_t i = 0; i < positions.size(); i++) {
+    positions[i] = glm::mix(frame.previous[i], frame.current[i], alpha);
+  }
+  return true;
+}
+
+void SimulationThread::Run() {
+  Frame& first = frames_.GetWriteBuffer();
+  read_positions_(first.current);
+  first.previous = first.current;
+  first.published = Clock::now();
+  first.valid = true;
+  frames_.Publish();
+
+  double accumulator = 0.0;
+  Clock::time_point last_time = Clock::now();
+  while (!stopping_) {
+    Clock::time_point now = Clock::now();
+    if (paused_) {
+      last_time = now;
+      std::this_thread::sleep_for(std::chrono::duration<double>(step_));
+      continue;
+    }
+    accumulator += std::min(
+        std::chrono::duration<double>(now - last_time).count(), kMaxLag);
+    last_time = now;
+    if (accumulator < step_) {
+      std::this_thread::sleep_for(
+          std::chrono::duration<double>(step_ - accumulator));
+      continue;
+    }
+
+    Frame& frame = frames_.GetWriteBuffer();
+    while (accumulator >= step_) {
+      if (accumulator < 2.0 * step_) {
+        read_positions_(frame.previous); /* before the batch's last step */
+      }
+      advance_(step_);
+      accumulator -= step_;
+      step_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    read_positions_(frame.current);
+    frame.leftover = accumulator; /* as of now; the batch's time is next */
+    frame.published = now;
+    frame.valid = true;
+    frames_.Publish();
+  }
+}
+}  // namespace GLOO
@@ -0,0 +1,78 @@
+#ifndef SIMULATION_THREAD_H_
+#define SIMULATION_THREAD_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "TripleBuffer.hpp"
+
+namespace GLOO {
+// Runs a simulation on its own thread at a fixed timestep, so that slow
+// steps do not stall rendering and slow frames do not change the steps.
+// Real time is accumulated and spent in whole steps ("Fix Your Timestep!");
+// after each batch of steps the positions before and after the last step
+// are published through a TripleBuffer. The render thread interpolates
+// between them by the time left over in the accumulator, so motion is
+// smooth at any frame rate, one step behind the simulation.
+class SimulationThread {
+ public:
+  // advance(dt) steps the simulation and read_positions copies its
+  // positions out; both are only called on the simulation thread.
+  SimulationThread(float step,
+                   std::function<void(float)> advance,
+                   std::function<void(std::vector<glm::vec3>&)> read_positions);
+  // Stops and joins the thread.
+  ~SimulationThread();
+
+  SimulationThread(const SimulationThread&) = delete;
+  SimulationThread& operator=(const SimulationThread&) = delete;
+
+  // Render thread: interpolated positions for now. Returns false until the
+  // first positions are published.
+  bool Interpolate(std::vector<glm::vec3>& positions);
+
+  // While paused no steps are taken and no real time accumulates, so the
+  // simulation resumes where it stopped.
+  void SetPaused(bool paused) {
+    paused_ = paused;
+  }
+
+  size_t GetStepCount() const {
+    return step_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Frame {
+    std::vector<glm::vec3> previous;
+    std::vector<glm::vec3> current;
+    double leftover = 0.0;  // Accumulated time not yet stepped, seconds.
+    Clock::time_point published;
+    bool valid = false;
+  };
+
+  void Run();
+
+  // Real time beyond this is dropped rather than caught up on, so a
+  // simulation slower than real time slows down instead of falling ever
+  // further behind.
+  static constexpr double kMaxLag = 0.25;
+
+  float step_;
+  std::function<void(float)> advance_;
+  std::function<void(std::vector<glm::vec3>&)> read_positions_;
+  TripleBuffer<Frame> frames_;
+  std::atomic<bool> stopping_;
+  std::atomic<bool> paused_;
+  std::atomic<size_t> step_count_;
+  std::thread thread_;
+};
+}  // namespace GLOO
+
+#endif
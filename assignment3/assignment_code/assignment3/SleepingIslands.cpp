@@ -0,0 +1,235 @@
+#include "SleepingIslands.hpp"
+
+#include <algorithm>
+
+namespace GLOO {
+namespace {
+int FindRoot(std::vector<int>& parents, int i) {
+  while (parents[i] != i) {
+    parents[i] = parents[parents[i]]; /* path halving */
+    i = parents[i];
+  }
+  return i;
+}
+}  // namespace
+
+SleepingIslands::SleepingIslands()
+    : sleep_energy_(0.0f),
+      sleep_delay_(0.0f),
+      springs_revision_(size_t(-1)),
+      awake_island_count_(0),
+      awake_changed_(false) {
+}
+
+void SleepingIslands::SetSleepThreshold(float energy_per_mass, float delay) {
+  sleep_energy_ = energy_per_mass;
+  sleep_delay_ = delay;
+  WakeAll();
+}
+
+size_t SleepingIslands::GetAwakeParticleCount() const {
+  if (awake_island_count_ == GetIslandCount()) {
+    return masses_.size();
+  }
+  return awake_particles_.size();
+}
+
+void SleepingIslands::Build(const PendulumSystem& system) {
+  size_t n = system.Masses.size();
+  masses_ = system.Masses;
+  fixed_mask_.assign(n, 0);
+  for (int i : system.Fixed) {
+    fixed_mask_[i] = 1;
+  }
+
+  std::vector<int> parents(n);
+  for (size_t i = 0; i < n; i++) {
+    parents[i] = int(i);
+  }
+  const SpringNetwork& springs = system.Springs;
+  for (size_t i = 0; i < springs.GetCount(); i++) {
+    int a = FindRoot(parents, springs.GetFirst(i));
+    int b = FindRoot(parents, springs.GetSecond(i));
+    if (a != b) {
+      parents[std::max(a, b)] = std::min(a, b);
+    }
+  }
+
+  /* islands are numbered by their lowest particle */
+  island_of_.assign(n, -1);
+  size_t island_count = 0;
+  for (size_t i = 0; i < n; i++) {
+    int root = FindRoot(parents, int(i));
+    if (island_of_[root] < 0) {
+      island_of_[root] = int(island_count++);
+    }
+    island_of_[i] = island_of_[root];
+  }
+  island_offsets_.assign(island_count + 1, 0);
+  for (size_t i = 0; i < n; i++) {
+    island_offsets_[island_of_[i] + 1]++;
+  }
+  for (size_t k = 0; k < island_count; k++) {
+    island_offsets_[k + 1] += island_offsets_[k];
+  }
+  island_particles_.resize(n);
+  std::vector<size_t> cursor(island_offsets_.begin(), island_offsets_.end() - 1);
+  for (size_t i = 0; i < n; i++) {
+    island_particles_[cursor[island_of_[i]]++] = int(i);
+  }
+
+  awake_.assign(island_count, 1);
+  still_time_.assign(island_count, 0.0f);
+  awake_island_count_ = island_count;
+  awake_changed_ = false;
+  springs_revision_ = springs.GetRevision();
+}
+
+void SleepingIslands::WakeAll() {
+  for (size_t k = 0; k < awake_.size(); k++) {
+    SetAwake(k, true);
+  }
+}
+
+void SleepingIslands::WakeIsland(int particle) {
+  if (size_t(particle) < island_of_.size()) {
+    SetAwake(island_of_[particle], true);
+  }
+}
+
+void SleepingIslands::SetAwake(size_t island, bool awake) {
+  still_time_[island] = 0.0f;
+  if (bool(awake_[island]) == awake) {
+    return;
+  }
+  awake_[island] = awake;
+  awake_island_count_ += awake ? 1 : -1;
+  awake_changed_ = true;
+}
+
+void SleepingIslands::BuildAwakeSystem(const PendulumSystem& system) {
+  size_t n = masses_.size();
+  std::vector<int> local(n, -1);
+  awake_particles_.clear();
+  /* reused rather than replaced, so its spring revision keeps counting up
+     and integrators that cache the topology notice the change */
+  awake_system_.Masses.clear();
+  awake_system_.Fixed.clear();
+  for (size_t i = 0; i < n; i++) {
+    if (awake_[island_of_[i]]) {
+      local[i] = int(awake_particles_.size());
+      awake_particles_.push_back(int(i));
+      awake_system_.AddMass(masses_[i]);
+    }
+  }
+  for (int i : system.Fixed) {
+    if (local[i] >= 0) {
+      awake_system_.Fix(local[i]);
+    }
+  }
+
+  /* renumbering keeps the order of the particles, so the awake springs
+     stay sorted */
+  const SpringNetwork& springs = system.Springs;
+  std::vector<int> indices;
+  std::vector<float> spring_consts;
+  std::vector<float> rest_lengths;
+  for (size_t i = 0; i < springs.GetCount(); i++) {
+    int a = local[springs.GetFirst(i)];
+    if (a >= 0) {
+      indices.push_back(a);
+      indices.push_back(local[springs.GetSecond(i)]);
+      spring_consts.push_back(springs.GetSpringConst(i));
+      rest_lengths.push_back(springs.GetRestLength(i));
+    }
+  }
+  awake_system_.Springs.Assign(std::move(indices), std::move(spring_consts),
+                               std::move(rest_lengths),
+                               awake_particles_.size());
+  awake_system_.SetDragConst(system.drag_const);
+  awake_changed_ = false;
+}
+
+void SleepingIslands::Step(
+    const IntegratorBase<PendulumSystem, ParticleState>& integrator,
+    const PendulumSystem& system,
+    CollisionSolver& collisions,
+    ParticleState& state,
+    float time,
+    float dt) {
+  if (sleep_energy_ <= 0.0f) {
+    integrator.Step(system, state, time, dt);
+    collisions.Resolve(state);
+    return;
+  }
+  if (springs_revision_ != system.Springs.GetRevision() ||
+      masses_.size() != system.Masses.size()) {
+    Build(system);
+  }
+  if (awake_island_count_ == 0) {
+    return;
+  }
+
+  if (awake_island_count_ == GetIslandCount()) {
+    integrator.Step(system, state, time, dt);
+  } else {
+    if (awake_changed_) {
+      BuildAwakeSystem(system);
+    }
+    awake_system_.SetThreadPool(system.GetThreadPool());
+    awake_system_.Fields = system.Fields;
+    size_t count = awake_particles_.size();
+    awake_state_.positions.resize(count);
+    awake_state_.velocities.resize(count);
+    for (size_t k = 0; k < count; k++) {
+      awake_state_.positions[k] = state.positions[awake_particles_[k]];
+      awake_state_.velocities[k] = state.velocities[awake_particles_[k]];
+    }
+    integrator.Step(awake_system_, awake_state_, time, dt);
+    for (size_t k = 0; k < count; k++) {
+      state.positions[awake_particles_[k]] = awake_state_.positions[k];
+      state.velocities[awake_particles_[k]] = awake_state_.velocities[k];
+    }
+  }
+  collisions.Resolve(state);
+  UpdateSleep(state, dt);
+}
+
+void SleepingIslands::UpdateSleep(ParticleState& state, float dt) {
+  for (size_t k = 0; k < GetIslandCount(); k++) {
+    const int* begin = &island_particles_[island_offsets_[k]];
+    const int* end = begin + (island_offsets_[k + 1] - island_offsets_[k]);
+    if (!awake_[k]) {
+      /* sleeping particles have zero velocity until something hits them */
+      for (const int* p = begin; p != end; p++) {
+        if (state.velocities[*p] != glm::vec3(0.0f)) {
+          SetAwake(k, true);
+          break;
+        }
+      }
+      continue;
+    }
+
+    float energy = 0.0f;
+    float mass = 0.0f;
+    for (const int* p = begin; p != end; p++) {
+      if (!fixed_mask_[*p]) {
+        const glm::vec3& v = state.velocities[*p];
+        energy += 0.5f * masses_[*p] * glm::dot(v, v);
+        mass += masses_[*p];
+      }
+    }
+    if (energy > sleep_energy_ * mass) {
+      still_time_[k] = 0.0f;
+      continue;
+    }
+    still_time_[k] += dt;
+    if (still_time_[k] >= sleep_delay_) {
+      SetAwake(k, false);
+      for (const int* p = begin; p != end; p++) {
+        state.velocities[*p] = glm::vec3(0.0f);
+      }
+    }
+  }
+}
+}  // namespace GLOO
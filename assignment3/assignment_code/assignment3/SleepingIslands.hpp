@@ -0,0 +1,84 @@
+#ifndef SLEEPING_ISLANDS_H_
+#define SLEEPING_ISLANDS_H_
+
+#include <vector>
+
+#include "CollisionSolver.hpp"
+#include "IntegratorBase.hpp"
+#include "ParticleState.hpp"
+#include "PendulumSystem.hpp"
+
+namespace GLOO {
+// Steps a PendulumSystem while letting parts of it at rest sleep. Particles
+// are grouped into islands, the connected components of the spring graph.
+// An island falls asleep once its kinetic energy per unit mass has stayed
+// below a threshold for a delay; its velocities are zeroed and it is left
+// out of force evaluation and integration until it wakes.
+//
+// While only some islands are awake, Step gathers them into a smaller
+// system and state, steps those and scatters the result back, so the cost
+// follows the awake particles. Collisions still see every particle, so
+// that an awake particle running into a sleeping island gives it a
+// velocity, which wakes it; once everything sleeps they are skipped too
+// and a step costs nothing. With no threshold set (the default) nothing
+// sleeps and Step is exactly an integrator step followed by collision
+// resolution.
+class SleepingIslands {
+ public:
+  SleepingIslands();
+
+  // Islands sleep once their kinetic energy per unit mass, in m^2/s^2, has
+  // stayed below energy_per_mass for delay seconds. 0 turns sleeping off.
+  void SetSleepThreshold(float energy_per_mass, float delay);
+
+  void Step(const IntegratorBase<PendulumSystem, ParticleState>& integrator,
+            const PendulumSystem& system,
+            CollisionSolver& collisions,
+            ParticleState& state,
+            float time,
+            float dt);
+  // For callers that change the state between steps: WakeAll after
+  // replacing it, e.g. on reset, and WakeIsland after pushing a particle.
+  void WakeAll();
+  void WakeIsland(int particle);
+
+  size_t GetIslandCount() const {
+    return island_offsets_.empty() ? 0 : island_offsets_.size() - 1;
+  }
+  size_t GetAwakeIslandCount() const {
+    return awake_island_count_;
+  }
+  size_t GetAwakeParticleCount() const;
+
+ private:
+  // Finds the islands of system; all start awake.
+  void Build(const PendulumSystem& system);
+  void BuildAwakeSystem(const PendulumSystem& system);
+  void UpdateSleep(ParticleState& state, float dt);
+  void SetAwake(size_t island, bool awake);
+
+  float sleep_energy_;
+  float sleep_delay_;
+
+  size_t springs_revision_;
+  std::vector<float> masses_;
+  std::vector<char> fixed_mask_;
+  std::vector<int> island_of_;
+  // Particles of island k are island_particles_[island_offsets_[k]] up to
+  // island_particles_[island_offsets_[k + 1]], in increasing order.
+  std::vector<size_t> island_offsets_;
+  std::vector<int> island_particles_;
+  std::vector<char> awake_;
+  std::vector<float> still_time_;
+  size_t awake_island_count_;
+  bool awake_changed_;
+
+  // Awake islands as a system of their own; particle k of it is
+  // awake_particles_[k] of the full system, in increasing order.
+  PendulumSystem awake_system_;
+  std::vector<int> awake_particles_;
+  ParticleState awake_state_;
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,25 @@
+#include "SparseBlockMatrix.hpp"
+
+namespace GLOO {
+void SparseBlockMatrix::SetStructure(size_t size,
+                                     const int* pairs,
+                                     size_t pair_count) {
+  diagonal_.assign(size, glm::mat3(0.0f));
+  off_diagonal_.assign(pair_count, glm::mat3(0.0f));
+  pairs_.assign(pairs, pairs + 2 * pair_count);
+}
+
+void SparseBlockMatrix::Multiply(const std::vector<glm::vec3>& x,
+                                 std::vector<glm::vec3>& y) const {
+  y.resize(diagonal_.size());
+  for (size_t i = 0; i < diagonal_.size(); i++) {
+    y[i] = diagonal_[i] * x[i];
+  }
+  for (size_t k = 0; k < off_diagonal_.size(); k++) {
+    int row = pairs_[2 * k];
+    int column = pairs_[2 * k + 1];
+    y[row] += off_diagonal_[k] * x[column];
+    y[column] += glm::transpose(off_diagonal_[k]) * x[row];
+  }
+}
+}  // namespace GLOO
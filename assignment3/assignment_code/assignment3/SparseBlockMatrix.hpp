@@ -0,0 +1,57 @@
+#ifndef SPARSE_BLOCK_MATRIX_H_
+#define SPARSE_BLOCK_MATRIX_H_
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace GLOO {
+// Symmetric matrix of 3x3 blocks over particles: one diagonal block per
+// particle plus a list of off-diagonal blocks, each stored once for its
+// (row, column) pair and applied to both (row, column) and (column, row) as
+// its transpose. A mass-spring system has exactly one such block per
+// spring, so the pattern is the spring network's index pairs.
+class SparseBlockMatrix {
+ public:
+  // Sets the size and the off-diagonal pattern and zeroes every block.
+  // Reusing a matrix of the same shape does not allocate.
+  void SetStructure(size_t size, const int* pairs, size_t pair_count);
+
+  size_t GetSize() const {
+    return diagonal_.size();
+  }
+  size_t GetBlockCount() const {
+    return off_diagonal_.size();
+  }
+  int GetRow(size_t block) const {
+    return pairs_[2 * block];
+  }
+  int GetColumn(size_t block) const {
+    return pairs_[2 * block + 1];
+  }
+
+  glm::mat3& Diagonal(size_t i) {
+    return diagonal_[i];
+  }
+  const glm::mat3& Diagonal(size_t i) const {
+    return diagonal_[i];
+  }
+  glm::mat3& OffDiagonal(size_t block) {
+    return off_diagonal_[block];
+  }
+  const glm::mat3& OffDiagonal(size_t block) const {
+    return off_diagonal_[block];
+  }
+
+  // y = A x. y is resized to the matrix size.
+  void Multiply(const std::vector<glm::vec3>& x,
+                std::vector<glm::vec3>& y) const;
+
+ private:
+  std::vector<glm::mat3> diagonal_;
+  std::vector<glm::mat3> off_diagonal_;
+  std::vector<int> pairs_;
+};
+}  // namespace GLOO
+
+#endif
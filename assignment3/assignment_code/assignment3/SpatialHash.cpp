@@ -0,0 +1,41 @@
+#include "SpatialHash.hpp"
+
+namespace GLOO {
+void SpatialHash::Build(const std::vector<glm::vec3>& positions,
+                        float radius) {
+  size_t count = positions.size();
+  cell_size_ = 2.0f * radius;
+  inverse_cell_size_ = 1.0f / cell_size_;
+
+  // Cells of twice the contact distance hold a few particles each, so one
+  // bucket per two particles keeps most cells apart while the table stays
+  // small enough to remain in cache.
+  size_t table_size = 1;
+  while (table_size < count / 2) {
+    table_size *= 2;
+  }
+  table_mask_ = uint32_t(table_size - 1);
+
+  buckets_.resize(count);
+  bucket_starts_.assign(table_size + 1, 0);
+  for (size_t i = 0; i < count; i++) {
+    buckets_[i] = BucketOf(CellOf(positions[i]));
+    bucket_starts_[buckets_[i]]++;
+  }
+  // Inclusive prefix sum gives each bucket's end; filling buckets back to
+  // front then walks every entry down to its bucket's start and keeps the
+  // particles of a bucket in index order.
+  for (size_t b = 1; b < table_size; b++) {
+    bucket_starts_[b] += bucket_starts_[b - 1];
+  }
+  bucket_starts_[table_size] = uint32_t(count);
+  sorted_.resize(count);
+  for (size_t i = count; i-- > 0;) {
+    sorted_[--bucket_starts_[buckets_[i]]] = uint32_t(i);
+  }
+  sorted_positions_.resize(count);
+  for (size_t k = 0; k < count; k++) {
+    sorted_positions_[k] = positions[sorted_[k]];
+  }
+}
+}  // namespace GLOO
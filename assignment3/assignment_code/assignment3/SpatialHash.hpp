@@ -0,0 +1,88 @@
+#ifndef SPATIAL_HASH_H_
+#define SPATIAL_HASH_H_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace GLOO {
+// Uniform grid over particle positions, stored as a hash table of cells so
+// that unbounded scenes need no bounding box. Build is linear: each particle
+// is hashed to a bucket, and a counting sort by bucket lays the particles of
+// each bucket out contiguously (Teschner et al., "Optimized Spatial Hashing
+// for Collision Detection of Deformable Objects").
+class SpatialHash {
+ public:
+  // Queries find every particle within radius of a point; cells are twice
+  // that size so a query only needs the 2x2x2 cells nearest the point.
+  void Build(const std::vector<glm::vec3>& positions, float radius);
+
+  // Calls func(j, position_j) for every particle j in the 2x2x2 cells
+  // around p, which include every particle within the build radius. Cells
+  // sharing a bucket are visited once, and a bucket can hold particles of
+  // other, distant cells, so callers still check the distance.
+  template <class TFunc>
+  void ForEachNear(const glm::vec3& p, const TFunc& func) const {
+    glm::vec3 scaled = p * inverse_cell_size_;
+    glm::vec3 floored = glm::floor(scaled);
+    glm::ivec3 cell(floored);
+    /* step towards the nearer neighbour on each axis */
+    glm::ivec3 side(scaled.x - floored.x < 0.5f ? -1 : 1,
+                    scaled.y - floored.y < 0.5f ? -1 : 1,
+                    scaled.z - floored.z < 0.5f ? -1 : 1);
+    uint32_t visited[8];
+    size_t visited_count = 0;
+    for (int corner = 0; corner < 8; corner++) {
+      glm::ivec3 offset((corner & 1) ? side.x : 0, (corner & 2) ? side.y : 0,
+                        (corner & 4) ? side.z : 0);
+      uint32_t bucket = BucketOf(cell + offset);
+      bool seen = false;
+      for (size_t k = 0; k < visited_count; k++) {
+        seen |= visited[k] == bucket;
+      }
+      if (seen) {
+        continue;
+      }
+      visited[visited_count++] = bucket;
+      for (uint32_t k = bucket_starts_[bucket]; k < bucket_starts_[bucket + 1];
+           k++) {
+        func(sorted_[k], sorted_positions_[k]);
+      }
+    }
+  }
+
+  // Particle indices grouped by bucket; iterating in this order keeps
+  // neighbouring queries close in memory.
+  const std::vector<uint32_t>& GetSortedIndices() const {
+    return sorted_;
+  }
+  float GetCellSize() const {
+    return cell_size_;
+  }
+
+ private:
+  glm::ivec3 CellOf(const glm::vec3& p) const {
+    return glm::ivec3(glm::floor(p * inverse_cell_size_));
+  }
+  uint32_t BucketOf(const glm::ivec3& cell) const {
+    uint32_t h = (uint32_t(cell.x) * 73856093u) ^
+                 (uint32_t(cell.y) * 19349663u) ^
+                 (uint32_t(cell.z) * 83492791u);
+    return h & table_mask_;
+  }
+
+  float cell_size_ = 1.0f;
+  float inverse_cell_size_ = 1.0f;
+  uint32_t table_mask_ = 0;
+  std::vector<uint32_t> buckets_;
+  std::vector<uint32_t> bucket_starts_;
+  std::vector<uint32_t> sorted_;
+  // Positions in bucket order, so a bucket's candidates are read
+  // contiguously.
+  std::vector<glm::vec3> sorted_positions_;
+};
+}  // namespace GLOO
+
+#endif
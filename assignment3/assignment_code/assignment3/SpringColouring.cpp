@@ -0,0 +1,62 @@
+#include "SpringColouring.hpp"
+
+#include <algorithm>
+
+namespace GLOO {
+SpringColouring::SpringColouring(const SpringNetwork& springs) {
+  size_t count = springs.GetCount();
+  size_t particle_count = 0;
+  for (size_t i = 0; i < count; i++) {
+    particle_count = std::max(particle_count, size_t(springs.GetSecond(i)) + 1);
+  }
+
+  std::vector<size_t> degrees(particle_count, 0);
+  size_t max_degree = 0;
+  for (size_t i = 0; i < count; i++) {
+    max_degree = std::max(max_degree, ++degrees[springs.GetFirst(i)]);
+    max_degree = std::max(max_degree, ++degrees[springs.GetSecond(i)]);
+  }
+
+  // One bit per colour per particle marks the colours already touching it.
+  size_t max_colours = std::max<size_t>(2 * max_degree, 1);
+  size_t words = (max_colours + 63) / 64;
+  std::vector<uint64_t> used(particle_count * words, 0);
+
+  std::vector<uint32_t> colours(count);
+  size_t colour_count = 0;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t* used_a = &used[springs.GetFirst(i) * words];
+    uint64_t* used_b = &used[springs.GetSecond(i) * words];
+    size_t colour = 0;
+    for (size_t w = 0; w < words; w++) {
+      uint64_t free_bits = ~(used_a[w] | used_b[w]);
+      if (free_bits != 0) {
+        size_t bit = 0;
+        while (!(free_bits & (uint64_t(1) << bit))) {
+          bit++;
+        }
+        colour = w * 64 + bit;
+        break;
+      }
+    }
+    used_a[colour / 64] |= uint64_t(1) << (colour % 64);
+    used_b[colour / 64] |= uint64_t(1) << (colour % 64);
+    colours[i] = uint32_t(colour);
+    colour_count = std::max(colour_count, colour + 1);
+  }
+
+  // Stable counting sort by colour keeps each colour in spring order.
+  offsets_.assign(colour_count + 1, 0);
+  for (size_t i = 0; i < count; i++) {
+    offsets_[colours[i] + 1]++;
+  }
+  for (size_t c = 0; c < colour_count; c++) {
+    offsets_[c + 1] += offsets_[c];
+  }
+  order_.resize(count);
+  std::vector<size_t> cursor(offsets_.begin(), offsets_.end() - 1);
+  for (size_t i = 0; i < count; i++) {
+    order_[cursor[colours[i]]++] = uint32_t(i);
+  }
+}
+}  // namespace GLOO
@@ -0,0 +1,43 @@
+#ifndef SPRING_COLOURING_H_
+#define SPRING_COLOURING_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "SpringNetwork.hpp"
+
+namespace GLOO {
+// Partition of a spring network into colours such that no two springs of
+// the same colour share a particle. Springs of one colour can therefore
+// scatter forces into their endpoints concurrently without races, and
+// processing the colours in order gives the same sums for any thread count.
+class SpringColouring {
+ public:
+  SpringColouring() {
+  }
+  // Greedy edge colouring in spring order; uses at most 2 * max_degree - 1
+  // colours.
+  explicit SpringColouring(const SpringNetwork& springs);
+
+  size_t GetColourCount() const {
+    return offsets_.empty() ? 0 : offsets_.size() - 1;
+  }
+  // Indices into the network of the springs with the given colour, in
+  // increasing order.
+  const uint32_t* GetSprings(size_t colour) const {
+    return order_.data() + offsets_[colour];
+  }
+  size_t GetSize(size_t colour) const {
+    return offsets_[colour + 1] - offsets_[colour];
+  }
+  size_t GetSpringCount() const {
+    return order_.size();
+  }
+
+ private:
+  std::vector<uint32_t> order_;
+  std::vector<size_t> offsets_;
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,215 @@
+#include "SpringNetwork.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace GLOO {
+void SpringNetwork::Add(int sphere_index1,
+                        int sphere_index2,
+                        float spring_const,
+                        float rest_length) {
+  if (sphere_index1 < 0 || sphere_index2 < 0 ||
+      sphere_index1 == sphere_index2) {
+    throw std::runtime_error("Invalid spring between particles " +
+                             std::to_string(sphere_index1) + " and " +
+                             std::to_string(sphere_index2) + "!");
+  }
+  // The force is symmetric in the endpoints, so store them ordered.
+  if (sphere_index1 > sphere_index2) {
+    std::swap(sphere_index1, sphere_index2);
+  }
+  indices_.push_back(sphere_index1);
+  indices_.push_back(sphere_index2);
+  spring_consts_.push_back(spring_const);
+  rest_lengths_.push_back(rest_length);
+  row_offsets_.clear();
+  sorted_ = false;
+  revision_++;
+}
+
+void SpringNetwork::Reserve(size_t count) {
+  indices_.reserve(2 * count);
+  spring_consts_.reserve(count);
+  rest_lengths_.reserve(count);
+}
+
+void SpringNetwork::Clear() {
+  indices_.clear();
+  spring_consts_.clear();
+  rest_lengths_.clear();
+  row_offsets_.clear();
+  sorted_ = true;
+  revision_++;
+}
+
+void SpringNetwork::Assign(std::vector<int> indices,
+                           std::vector<float> spring_consts,
+                           std::vector<float> rest_lengths,
+                           size_t particle_count) {
+  size_t count = spring_consts.size();
+  if (indices.size() != 2 * count || rest_lengths.size() != count) {
+    throw std::runtime_error("Cannot assign springs with inconsistent sizes!");
+  }
+  bool ordered = true;
+  size_t rows = particle_count;
+  for (size_t i = 0; i < count; i++) {
+    int& a = indices[2 * i];
+    int& b = indices[2 * i + 1];
+    if (a < 0 || b < 0 || a == b) {
+      throw std::runtime_error("Invalid spring between particles " +
+                               std::to_string(a) + " and " +
+                               std::to_string(b) + "!");
+    }
+    if (a > b) {
+      std::swap(a, b);
+    }
+    if (i > 0) {
+      int pa = indices[2 * i - 2];
+      int pb = indices[2 * i - 1];
+      ordered &= pa < a || (pa == a && pb <= b);
+    }
+    rows = std::max(rows, size_t(b) + 1);
+  }
+
+  indices_ = std::move(indices);
+  spring_consts_ = std::move(spring_consts);
+  rest_lengths_ = std::move(rest_lengths);
+  revision_++;
+  if (!ordered) {
+    sorted_ = false;
+    Sort(rows);
+    return;
+  }
+  row_offsets_.assign(rows + 1, 0);
+  for (size_t i = 0; i < count; i++) {
+    row_offsets_[indices_[2 * i] + 1]++;
+  }
+  for (size_t r = 0; r < rows; r++) {
+    row_offsets_[r + 1] += row_offsets_[r];
+  }
+  sorted_ = true;
+}
+
+void SpringNetwork::Sort(size_t particle_count) {
+  size_t count = GetCount();
+  size_t rows = particle_count;
+  for (size_t i = 0; i < count; i++) {
+    rows = std::max(rows, size_t(GetSecond(i)) + 1);
+  }
+
+  // Counting sort by first endpoint gives the row offsets directly; each
+  // row is short, so it is then sorted by second endpoint in place.
+  std::vector<size_t> offsets(rows + 1, 0);
+  for (size_t i = 0; i < count; i++) {
+    offsets[GetFirst(i) + 1]++;
+  }
+  for (size_t r = 0; r < rows; r++) {
+    offsets[r + 1] += offsets[r];
+  }
+  std::vector<size_t> order(count);
+  std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+  for (size_t i = 0; i < count; i++) {
+    order[cursor[GetFirst(i)]++] = i;
+  }
+  for (size_t r = 0; r < rows; r++) {
+    std::sort(order.begin() + offsets[r], order.begin() + offsets[r + 1],
+              [this](size_t a, size_t b) {
+                return GetSecond(a) < GetSecond(b) ||
+                       (GetSecond(a) == GetSecond(b) && a < b);
+              });
+  }
+
+  std::vector<int> indices(2 * count);
+  std::vector<float> spring_consts(count);
+  std::vector<float> rest_lengths(count);
+  for (size_t i = 0; i < count; i++) {
+    indices[2 * i] = indices_[2 * order[i]];
+    indices[2 * i + 1] = indices_[2 * order[i] + 1];
+    spring_consts[i] = spring_consts_[order[i]];
+    rest_lengths[i] = rest_lengths_[order[i]];
+  }
+  indices_ = std::move(indices);
+  spring_consts_ = std::move(spring_consts);
+  rest_lengths_ = std::move(rest_lengths);
+  row_offsets_ = std::move(offsets);
+  sorted_ = true;
+  revision_++;
+}
+
+SpringNetwork SpringNetwork::Load(const std::string& file_path) {
+  std::ifstream fs(file_path, std::ios::binary);
+  if (!fs) {
+    throw std::runtime_error("Cannot load " + file_path + "!");
+  }
+  std::stringstream buffer;
+  buffer << fs.rdbuf();
+  std::string text = buffer.str();
+
+  // Hand-rolled parsing: streams are several times slower on networks with
+  // hundreds of thousands of springs.
+  SpringNetwork network;
+  const char* p = text.c_str();
+  size_t line_number = 0;
+  while (*p != '\0') {
+    line_number++;
+    const char* line_end = strchr(p, '\n');
+    if (line_end == nullptr) {
+      line_end = p + strlen(p);
+    }
+    while (p < line_end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+      p++;
+    }
+    if (p == line_end || *p == '#') {
+      // Blank line or comment.
+    } else if (strncmp(p, "springs", 7) == 0) {
+      network.Reserve(strtoul(p + 7, nullptr, 10));
+    } else {
+      // Every field must parse and stay on this line.
+      bool parsed = true;
+      char* end;
+      long a = strtol(p, &end, 10);
+      parsed &= end != p;
+      const char* field = end;
+      long b = strtol(field, &end, 10);
+      parsed &= end != field;
+      field = end;
+      float k = strtof(field, &end);
+      parsed &= end != field;
+      field = end;
+      float rest_length = strtof(field, &end);
+      parsed &= end != field;
+      parsed &= a >= 0 && a <= INT_MAX && b >= 0 && b <= INT_MAX;
+      if (!parsed || end > line_end) {
+        throw std::runtime_error("Malformed spring on line " +
+                                 std::to_string(line_number) + " of " +
+                                 file_path + "!");
+      }
+      network.Add(int(a), int(b), k, rest_length);
+    }
+    p = *line_end == '\0' ? line_end : line_end + 1;
+  }
+
+  network.Sort();
+  return network;
+}
+
+void SpringNetwork::Save(const std::string& file_path) const {
+  FILE* file = fopen(file_path.c_str(), "w");
+  if (file == nullptr) {
+    throw std::runtime_error("Cannot write " + file_path + "!");
+  }
+  fprintf(file, "springs %zu\n", GetCount());
+  for (size_t i = 0; i < GetCount(); i++) {
+    fprintf(file, "%d %d %.9g %.9g\n", GetFirst(i), GetSecond(i),
+            GetSpringConst(i), GetRestLength(i));
+  }
+  fclose(file);
+}
+}  // namespace GLOO
@@ -0,0 +1,95 @@
+#ifndef SPRING_NETWORK_H_
+#define SPRING_NETWORK_H_
+
+#include <string>
+#include <vector>
+
+namespace GLOO {
+// Springs stored as flat arrays: index pairs (first < second) plus parallel
+// stiffness and rest-length arrays. Sort() orders springs by their endpoints
+// and builds a CSR row index, so the springs whose lower endpoint is
+// particle i are the contiguous range [GetRowBegin(i), GetRowEnd(i)).
+class SpringNetwork {
+ public:
+  void Add(int sphere_index1,
+           int sphere_index2,
+           float spring_const,
+           float rest_length);
+  void Reserve(size_t count);
+  void Clear();
+  // Replaces all springs at once, e.g. from a generator. indices holds two
+  // endpoints per spring. Springs already ordered as Sort() would order
+  // them get their row index in one linear pass; others are sorted.
+  void Assign(std::vector<int> indices,
+              std::vector<float> spring_consts,
+              std::vector<float> rest_lengths,
+              size_t particle_count = 0);
+
+  // Sorts springs by (first, second) for locality and builds the row index
+  // over particle_count particles (0 uses the largest index seen).
+  void Sort(size_t particle_count = 0);
+  bool IsSorted() const {
+    return sorted_;
+  }
+  // Changes whenever springs are added, removed or reordered, so derived
+  // data such as a SpringColouring can tell when it is stale.
+  size_t GetRevision() const {
+    return revision_;
+  }
+
+  size_t GetCount() const {
+    return spring_consts_.size();
+  }
+  int GetFirst(size_t i) const {
+    return indices_[2 * i];
+  }
+  int GetSecond(size_t i) const {
+    return indices_[2 * i + 1];
+  }
+  float GetSpringConst(size_t i) const {
+    return spring_consts_[i];
+  }
+  float GetRestLength(size_t i) const {
+    return rest_lengths_[i];
+  }
+  // Flat arrays, for tight loops.
+  const int* GetIndices() const {
+    return indices_.data();
+  }
+  const float* GetSpringConsts() const {
+    return spring_consts_.data();
+  }
+  const float* GetRestLengths() const {
+    return rest_lengths_.data();
+  }
+
+  // Valid after Sort().
+  size_t GetRowCount() const {
+    return row_offsets_.empty() ? 0 : row_offsets_.size() - 1;
+  }
+  size_t GetRowBegin(size_t particle) const {
+    return row_offsets_[particle];
+  }
+  size_t GetRowEnd(size_t particle) const {
+    return row_offsets_[particle + 1];
+  }
+
+  // Text format: optional "springs <count>" header, then one spring per
+  // line as "<first> <second> <spring_const> <rest_length>". Lines starting
+  // with '#' are comments; endpoints must be non-negative ints. The loaded
+  // network is sorted. Endpoints are checked against a system's particles
+  // by PendulumSystem::SetSprings.
+  static SpringNetwork Load(const std::string& file_path);
+  void Save(const std::string& file_path) const;
+
+ private:
+  std::vector<int> indices_;
+  std::vector<float> spring_consts_;
+  std::vector<float> rest_lengths_;
+  std::vector<size_t> row_offsets_;
+  bool sorted_ = true;
+  size_t revision_ = 0;
+};
+}  // namespace GLOO
+
+#endif
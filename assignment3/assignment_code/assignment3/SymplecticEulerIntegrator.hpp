@@ -0,0 +1,30 @@
+#ifndef SYMPLECTIC_EULER_INTEGRATOR_H_
+#define SYMPLECTIC_EULER_INTEGRATOR_H_
+
+#include "IntegratorBase.hpp"
+
+namespace GLOO {
+// Semi-implicit Euler for second order systems, whose position derivative
+// is the velocity: velocities are updated from the current forces, then
+// positions from the new velocities. Same cost as forward Euler (one
+// derivative per step) but symplectic, so the energy of an undamped system
+// oscillates around its true value instead of growing.
+template <class TSystem, class TState>
+class SymplecticEulerIntegrator : public IntegratorBase<TSystem, TState> {
+ public:
+  SymplecticEulerIntegrator() : IntegratorBase<TSystem, TState>(1) {
+  }
+
+  void Step(const TSystem& system,
+            TState& state,
+            float start_time,
+            float dt) const override {
+    TState& f = this->Workspace(0);
+    system.ComputeTimeDerivative(state, start_time, f);
+    Kick(state, dt, f);
+    Drift(state, dt);
+  }
+};
+}  // namespace GLOO
+
+#endif
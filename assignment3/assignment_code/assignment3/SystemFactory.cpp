@@ -0,0 +1,122 @@
+#include "SystemFactory.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace GLOO {
+ParticleState SystemFactory::CreatePendulumState() {
+    auto pendulum_state = ParticleState();
+
+    std::vector<glm::vec3> pendulum_positions_ = {glm::vec3(0.5, 0.0, 0), glm::vec3(1.0, 0.0, 0), glm::vec3(1.5, 0.0, 0), glm::vec3(2.0, 0.0, 0)};
+    std::vector<glm::vec3> pendulum_velocities_ = {glm::vec3(0, 0, 0), glm::vec3(0, 0, 0), glm::vec3(0, 0, 0), glm::vec3(0, 0, 0)};
+
+    pendulum_state.positions = pendulum_positions_;
+    pendulum_state.velocities = pendulum_velocities_;
+    return pendulum_state;
+}
+
+ParticleState SystemFactory::CreateClothState(const ClothDescription& cloth) {
+    auto cloth_state = ParticleState();
+    size_t count = size_t(cloth.width) * cloth.height;
+    cloth_state.positions.reserve(count);
+    cloth_state.velocities.assign(count, glm::vec3(0, 0, 0));
+
+    for (int i = 0; i < cloth.height; i++) {
+      for (int j = 0; j < cloth.width; j++) {
+        glm::vec3 offset = cloth.origin + glm::vec3(j*cloth.spacing, 0, 0) + glm::vec3(0, -i*cloth.spacing, 0);
+        cloth_state.positions.push_back(offset);
+      }
+    }
+    return cloth_state;
+}
+
+void SystemFactory::BuildPendulum(const ParticleState& state, PendulumSystem& system) {
+    for (int i = 0; i < state.positions.size(); i++) {
+        system.AddMass(5.0); /* add sphere to system with mass */
+    }
+    system.SetDragConst(1.5);
+
+    for (int i = 0; i < state.positions.size() - 1; i ++) {
+        system.AddSpring(i, i + 1, 200.0, 0.25);
+    }
+    system.Springs.Sort(state.positions.size());
+    system.Fix(0);
+    // system.Fix(3);
+}
+
+void SystemFactory::BuildCloth(const ClothDescription& cloth,
+                               PendulumSystem& system,
+                               CollisionSolver& collisions) {
+    int width = cloth.width;
+    int height = cloth.height;
+    size_t count = size_t(width) * height;
+    system.Masses.assign(count, cloth.mass); /* add spheres to system with mass */
+    system.SetDragConst(cloth.drag_const);
+    for (const glm::ivec2& pin : cloth.pins) {
+        int column = pin.x < 0 ? width + pin.x : pin.x; /* negative pins count from the far side */
+        int row = pin.y < 0 ? height + pin.y : pin.y;
+        if (column < 0 || column >= width || row < 0 || row >= height) {
+            throw std::runtime_error("Cannot pin particle (" + std::to_string(pin.x) + ", " +
+                                     std::to_string(pin.y) + ") outside the cloth!");
+        }
+        system.Fix(cloth.IndexOf(column, row)); /* fix corners to create draping effect */
+    }
+
+    if (!cloth.springs_file.empty()) {
+        system.SetSprings(SpringNetwork::Load(cloth.springs_file)); /* e.g. a cut or a custom weave */
+    } else {
+        float structural_rest = cloth.structural.rest_ratio*cloth.spacing;
+        float shear_rest = cloth.shear.rest_ratio*cloth.spacing;
+        float flex_rest = cloth.flex.rest_ratio*cloth.spacing;
+
+        /* each particle's springs to higher indices, in increasing order of the
+           other end, so particles in index order give the sorted network */
+        std::vector<int> indices;
+        std::vector<float> spring_consts;
+        std::vector<float> rest_lengths;
+        indices.reserve(12*count);
+        spring_consts.reserve(6*count);
+        rest_lengths.reserve(6*count);
+        auto add = [&](int a, int b, const ClothSpringType& type, float rest_length) {
+            indices.push_back(a);
+            indices.push_back(b);
+            spring_consts.push_back(type.spring_const);
+            rest_lengths.push_back(rest_length);
+        };
+        for (int row = 0; row < height; row++) {
+            for (int column = 0; column < width; column++) {
+                int p = cloth.IndexOf(column, row);
+                if (column + 1 < width) {
+                    add(p, p + 1, cloth.structural, structural_rest); /* add structural springs */
+                }
+                if (column + 2 < width) {
+                    add(p, p + 2, cloth.flex, flex_rest); /* add flex springs */
+                }
+                if (column > 0 && row + 1 < height) {
+                    add(p, p + width - 1, cloth.shear, shear_rest); /* add shear springs */
+                }
+                if (row + 1 < height) {
+                    add(p, p + width, cloth.structural, structural_rest);
+                }
+                if (column + 1 < width && row + 1 < height) {
+                    add(p, p + width + 1, cloth.shear, shear_rest);
+                }
+                if (row + 2 < height) {
+                    add(p, p + 2*width, cloth.flex, flex_rest);
+                }
+            }
+        }
+        system.Springs.Assign(std::move(indices), std::move(spring_consts), std::move(rest_lengths), count);
+    }
+    system.SetGrid(height, width); /* particle (column, row) is row*width + column */
+
+    collisions.SetParticleRadius(cloth.particle_radius); /* radius of the drawn spheres */
+    collisions.SetFixed(system.Fixed);
+    if (cloth.self_collision) {
+        collisions.EnableParticleCollisions(system.Springs); /* self-collision */
+    }
+    if (cloth.floor) {
+        collisions.AddPlane(glm::vec3(0, 1, 0), cloth.floor_height); /* floor below the drape */
+    }
+}
+}  // namespace GLOO
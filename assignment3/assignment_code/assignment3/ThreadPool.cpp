@@ -0,0 +1,97 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace GLOO {
+ThreadPool::ThreadPool(size_t thread_count)
+    : stopping_(false),
+      generation_(0),
+      busy_workers_(0),
+      func_(nullptr),
+      count_(0),
+      chunk_size_(1),
+      next_chunk_(0) {
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (size_t i = 1; i < thread_count; i++) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_ready_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::ParallelFor(size_t count,
+                             size_t grain,
+                             const std::function<void(size_t, size_t)>& func) {
+  grain = std::max<size_t>(grain, 1);
+  if (workers_.empty() || count <= grain) {
+    if (count > 0) {
+      func(0, count);
+    }
+    return;
+  }
+
+  // A few chunks per thread balance uneven work without much overhead.
+  size_t chunks = std::min((count + grain - 1) / grain, 4 * GetThreadCount());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    func_ = &func;
+    count_ = count;
+    chunk_size_ = (count + chunks - 1) / chunks;
+    next_chunk_ = 0;
+    busy_workers_ = workers_.size();
+    generation_++;
+  }
+  work_ready_.notify_all();
+
+  RunChunks();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this] { return busy_workers_ == 0; });
+  func_ = nullptr;
+}
+
+void ThreadPool::RunChunks() {
+  while (true) {
+    size_t begin = next_chunk_.fetch_add(1) * chunk_size_;
+    if (begin >= count_) {
+      return;
+    }
+    (*func_)(begin, std::min(begin + chunk_size_, count_));
+  }
+}
+
+void ThreadPool::WorkerLoop() {
+  size_t seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_ready_.wait(lock, [&] {
+        return stopping_ || generation_ != seen_generation;
+      });
+      if (stopping_) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+
+    RunChunks();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busy_workers_--;
+    }
+    work_done_.notify_one();
+  }
+}
+}  // namespace GLOO
@@ -0,0 +1,53 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GLOO {
+// Fixed set of worker threads for data-parallel loops. ParallelFor blocks
+// until the whole range is done; the calling thread works on it too.
+class ThreadPool {
+ public:
+  // thread_count includes the calling thread; 0 uses every hardware thread.
+  explicit ThreadPool(size_t thread_count = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t GetThreadCount() const {
+    return workers_.size() + 1;
+  }
+
+  // Calls func(begin, end) on disjoint chunks covering [0, count). Chunks
+  // hold at least grain items; ranges below one grain run inline.
+  void ParallelFor(size_t count,
+                   size_t grain,
+                   const std::function<void(size_t, size_t)>& func);
+
+ private:
+  void WorkerLoop();
+  void RunChunks();
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable work_done_;
+  bool stopping_;
+  size_t generation_;
+  size_t busy_workers_;
+
+  // The job in flight.
+  const std::function<void(size_t, size_t)>* func_;
+  size_t count_;
+  size_t chunk_size_;
+  std::atomic<size_t> next_chunk_;
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,138 @@
+#include "Trajectory.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace GLOO {
+namespace {
+const char kMagic[4] = {'A', '3', 'T', 'J'};
+const uint32_t kVersion = 1;
+const float kQuantizedMax = 65535.0f;
+
+template <class T>
+void Write(std::ofstream& file, const T& value) {
+  file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+bool Read(std::ifstream& file, T& value) {
+  return bool(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+}  // namespace
+
+TrajectoryWriter::TrajectoryWriter(const std::string& path,
+                                   size_t particle_count,
+                                   TrajectoryEncoding encoding,
+                                   float step)
+    : file_(path, std::ios::binary),
+      particle_count_(particle_count),
+      encoding_(encoding),
+      quantized_(3 * particle_count) {
+  if (!file_) {
+    throw std::runtime_error("Cannot open " + path + " for writing!");
+  }
+  file_.write(kMagic, sizeof(kMagic));
+  Write(file_, kVersion);
+  Write(file_, uint32_t(particle_count));
+  Write(file_, uint32_t(encoding));
+  Write(file_, step);
+}
+
+void TrajectoryWriter::WriteFrame(double time, const ParticleState& state) {
+  if (state.positions.size() != particle_count_) {
+    throw std::runtime_error("Cannot write a frame of a different size!");
+  }
+  Write(file_, time);
+  WriteArray(state.positions);
+  WriteArray(state.velocities);
+  if (!file_) {
+    throw std::runtime_error("Cannot write trajectory frame!");
+  }
+}
+
+void TrajectoryWriter::WriteArray(const std::vector<glm::vec3>& values) {
+  if (encoding_ == TrajectoryEncoding::Float32) {
+    file_.write(reinterpret_cast<const char*>(values.data()),
+                sizeof(glm::vec3) * values.size());
+    return;
+  }
+  glm::vec3 low(0.0f), high(0.0f);
+  if (!values.empty()) {
+    low = high = values[0];
+  }
+  for (const glm::vec3& v : values) {
+    low = glm::min(low, v);
+    high = glm::max(high, v);
+  }
+  glm::vec3 extent = high - low;
+  glm::vec3 scale(0.0f);
+  for (int k = 0; k < 3; k++) {
+    if (extent[k] > 0.0f) {
+      scale[k] = kQuantizedMax / extent[k];
+    }
+  }
+  for (size_t i = 0; i < values.size(); i++) {
+    glm::vec3 q = (values[i] - low) * scale + 0.5f;
+    for (int k = 0; k < 3; k++) {
+      quantized_[3 * i + k] = uint16_t(std::min(q[k], kQuantizedMax));
+    }
+  }
+  Write(file_, low);
+  Write(file_, high);
+  file_.write(reinterpret_cast<const char*>(quantized_.data()),
+              sizeof(uint16_t) * 3 * values.size());
+}
+
+TrajectoryReader::TrajectoryReader(const std::string& path)
+    : file_(path, std::ios::binary) {
+  if (!file_) {
+    throw std::runtime_error("Cannot open " + path + " for reading!");
+  }
+  char magic[4];
+  uint32_t version, particle_count, encoding;
+  if (!file_.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kMagic, sizeof(magic)) != 0 ||
+      !Read(file_, version) || version != kVersion ||
+      !Read(file_, particle_count) || !Read(file_, encoding) ||
+      (encoding != uint32_t(TrajectoryEncoding::Float32) &&
+       encoding != uint32_t(TrajectoryEncoding::Quantized16)) ||
+      !Read(file_, step_)) {
+    throw std::runtime_error("Cannot read trajectory header of " + path + "!");
+  }
+  particle_count_ = particle_count;
+  encoding_ = TrajectoryEncoding(encoding);
+  quantized_.resize(3 * particle_count_);
+}
+
+bool TrajectoryReader::ReadFrame(double& time, ParticleState& state) {
+  if (!Read(file_, time)) {
+    return false;
+  }
+  if (!ReadArray(state.positions) || !ReadArray(state.velocities)) {
+    throw std::runtime_error("Cannot read truncated trajectory frame!");
+  }
+  return true;
+}
+
+bool TrajectoryReader::ReadArray(std::vector<glm::vec3>& values) {
+  values.resize(particle_count_);
+  if (encoding_ == TrajectoryEncoding::Float32) {
+    return bool(file_.read(reinterpret_cast<char*>(values.data()),
+                           sizeof(glm::vec3) * values.size()));
+  }
+  glm::vec3 low, high;
+  if (!Read(file_, low) || !Read(file_, high) ||
+      !file_.read(reinterpret_cast<char*>(quantized_.data()),
+                  sizeof(uint16_t) * quantized_.size())) {
+    return false;
+  }
+  glm::vec3 step = (high - low) / kQuantizedMax;
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = low + step * glm::vec3(quantized_[3 * i],
+                                       quantized_[3 * i + 1],
+                                       quantized_[3 * i + 2]);
+  }
+  return true;
+}
+}  // namespace GLOO
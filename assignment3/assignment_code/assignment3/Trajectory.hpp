@@ -0,0 +1,70 @@
+#ifndef TRAJECTORY_H_
+#define TRAJECTORY_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ParticleState.hpp"
+
+namespace GLOO {
+// How positions and velocities are stored in each frame. Quantized16 keeps,
+// per frame and per array, the bounding box and 16 bits per component
+// within it: about half the size of Float32 (8 + 48 + 12N bytes a frame
+// against 8 + 24N), at a precision of 1/65535 of the extent.
+enum class TrajectoryEncoding : uint32_t { Float32 = 0, Quantized16 = 1 };
+
+// Binary trajectory file, in native byte order:
+//   header: "A3TJ", version, particle count, encoding (uint32 each), step
+//           (float32)
+//   frame:  time (float64), positions, velocities
+class TrajectoryWriter {
+ public:
+  TrajectoryWriter(const std::string& path,
+                   size_t particle_count,
+                   TrajectoryEncoding encoding,
+                   float step);
+
+  void WriteFrame(double time, const ParticleState& state);
+
+ private:
+  void WriteArray(const std::vector<glm::vec3>& values);
+
+  std::ofstream file_;
+  size_t particle_count_;
+  TrajectoryEncoding encoding_;
+  std::vector<uint16_t> quantized_;
+};
+
+class TrajectoryReader {
+ public:
+  explicit TrajectoryReader(const std::string& path);
+
+  size_t GetParticleCount() const {
+    return particle_count_;
+  }
+  TrajectoryEncoding GetEncoding() const {
+    return encoding_;
+  }
+  float GetStep() const {
+    return step_;
+  }
+
+  // Returns false at the end of the file.
+  bool ReadFrame(double& time, ParticleState& state);
+
+ private:
+  bool ReadArray(std::vector<glm::vec3>& values);
+
+  std::ifstream file_;
+  size_t particle_count_;
+  TrajectoryEncoding encoding_;
+  float step_;
+  std::vector<uint16_t> quantized_;
+};
+}  // namespace GLOO
+
+#endif
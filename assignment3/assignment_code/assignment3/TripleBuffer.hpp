@@ -0,0 +1,53 @@
+#ifndef TRIPLE_BUFFER_H_
+#define TRIPLE_BUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace GLOO {
+// Lock-free handoff of whole values from one writer thread to one reader
+// thread. The writer fills its back buffer and publishes it by swapping it
+// with the middle buffer; the reader takes the middle buffer when a new one
+// has been published. Neither side ever waits, and the reader always sees
+// the latest complete value.
+template <class T>
+class TripleBuffer {
+ public:
+  TripleBuffer() : middle_(1), write_(0), read_(2) {
+  }
+
+  // Writer side.
+  T& GetWriteBuffer() {
+    return buffers_[write_];
+  }
+  void Publish() {
+    uint32_t previous =
+        middle_.exchange(write_ | kFresh, std::memory_order_acq_rel);
+    write_ = previous & kIndexMask;
+  }
+
+  // Reader side. Returns whether a newer value was taken.
+  bool Update() {
+    if (!(middle_.load(std::memory_order_relaxed) & kFresh)) {
+      return false;
+    }
+    uint32_t previous = middle_.exchange(read_, std::memory_order_acq_rel);
+    read_ = previous & kIndexMask;
+    return true;
+  }
+  const T& GetReadBuffer() const {
+    return buffers_[read_];
+  }
+
+ private:
+  static const uint32_t kIndexMask = 3;
+  static const uint32_t kFresh = 4;
+
+  T buffers_[3];
+  std::atomic<uint32_t> middle_;  // Buffer index, plus kFresh if unread.
+  uint32_t write_;
+  uint32_t read_;
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef VELOCITY_VERLET_INTEGRATOR_H_
+#define VELOCITY_VERLET_INTEGRATOR_H_
+
+#include "IntegratorBase.hpp"
+
+namespace GLOO {
+// Velocity Verlet (kick-drift-kick) for second order systems, whose
+// position derivative is the velocity: second order accurate and
+// symplectic. The closing half kick's accelerations are those at the start
+// of the next step, so they are kept and reused when the next step starts
+// from the state this one produced, leaving one derivative per step.
+// Velocity dependent forces such as drag see the half-step velocity.
+template <class TSystem, class TState>
+class VelocityVerletIntegrator : public IntegratorBase<TSystem, TState> {
+ public:
+  VelocityVerletIntegrator()
+      : IntegratorBase<TSystem, TState>(2), cache_valid_(false) {
+  }
+
+  void Step(const TSystem& system,
+            TState& state,
+            float start_time,
+            float dt) const override {
+    TState& f = this->Workspace(0);
+    TState& last_state = this->Workspace(1);
+
+    /* anything else (a reset, a different system state) recomputes */
+    if (!cache_valid_ || !(state == last_state)) {
+      system.ComputeTimeDerivative(state, start_time, f);
+    }
+    Kick(state, dt / 2.0f, f);
+    Drift(state, dt);
+    system.ComputeTimeDerivative(state, start_time + dt, f);
+    Kick(state, dt / 2.0f, f);
+
+    last_state = state;
+    cache_valid_ = true;
+  }
+
+ private:
+  mutable bool cache_valid_;
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef XPBD_INTEGRATOR_H_
+#define XPBD_INTEGRATOR_H_
+
+#include <vector>
+
+#include "IntegratorBase.hpp"
+#include "PendulumSystem.hpp"
+#include "XpbdSolver.hpp"
+
+namespace GLOO {
+// Runs a PendulumSystem's masses and springs through XpbdSolver instead of
+// integrating its forces: springs become distance constraints and fixed
+// particles are pinned where they are when the solver is built. The solver
+// is rebuilt when the springs, masses or fixed particles change. Like the
+// adaptive integrators it takes its own substeps, so callers hand it whole
+// frames.
+class XpbdIntegrator : public IntegratorBase<PendulumSystem, ParticleState> {
+ public:
+  XpbdIntegrator() : spring_revision_(size_t(-1)), substeps_taken_(0) {
+  }
+
+  void Step(const PendulumSystem& system,
+            ParticleState& state,
+            float start_time,
+            float dt) const override {
+    if (spring_revision_ != system.Springs.GetRevision() ||
+        masses_ != system.Masses || fixed_ != system.Fixed) {
+      solver_.ClearPins();
+      solver_.SetMasses(system.Masses);
+      solver_.SetConstraints(system.Springs);
+      for (int particle : system.Fixed) {
+        solver_.Pin(particle, state.positions[particle]);
+      }
+      spring_revision_ = system.Springs.GetRevision();
+      masses_ = system.Masses;
+      fixed_ = system.Fixed;
+    }
+    /* force fields are sampled at the start of the frame and held over
+       its substeps; their pull towards the air's velocity is split into a
+       push sampled at rest and drag the solver decays exactly */
+    solver_.SetDragConst(system.drag_const + system.Fields.GetDrag());
+    field_forces_.clear();
+    if (!system.Fields.IsEmpty()) {
+      field_forces_.assign(state.positions.size(), glm::vec3(0.0f));
+      at_rest_.assign(state.positions.size(), glm::vec3(0.0f));
+      system.Fields.AddForces(state.positions.data(), at_rest_.data(),
+                              system.Masses.data(), start_time,
+                              state.positions.size(), field_forces_.data());
+    }
+    solver_.SetExternalForces(field_forces_);
+    solver_.SetThreadPool(system.GetThreadPool());
+    solver_.Step(state, dt);
+    substeps_taken_ += solver_.GetSubsteps();
+  }
+
+  bool IsAdaptive() const override {
+    return true;
+  }
+  size_t GetAcceptedSteps() const override {
+    return substeps_taken_;
+  }
+
+  XpbdSolver& GetSolver() {
+    return solver_;
+  }
+
+ private:
+  mutable XpbdSolver solver_;
+  mutable size_t spring_revision_;
+  mutable std::vector<float> masses_;
+  mutable std::vector<int> fixed_;
+  mutable std::vector<glm::vec3> field_forces_;
+  mutable std::vector<glm::vec3> at_rest_;
+  mutable size_t substeps_taken_;
+};
+}  // namespace GLOO
+
+#endif
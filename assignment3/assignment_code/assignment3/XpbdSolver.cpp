@@ -0,0 +1,145 @@
+#include "XpbdSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+namespace GLOO {
+XpbdSolver::XpbdSolver() : drag_const_(0.0f), substeps_(10) {
+}
+
+void XpbdSolver::SetMasses(const std::vector<float>& masses) {
+  masses_ = masses;
+  drag_rates_.resize(masses.size());
+  UpdateInverseMasses();
+}
+
+void XpbdSolver::SetConstraints(const SpringNetwork& springs) {
+  constraints_ = springs;
+  colouring_ = SpringColouring(constraints_);
+  compliances_.resize(constraints_.GetCount());
+  for (size_t i = 0; i < constraints_.GetCount(); i++) {
+    float k = constraints_.GetSpringConst(i);
+    compliances_[i] = k > 0.0f ? 1.0f / k : 0.0f;
+  }
+  lambdas_.assign(constraints_.GetCount(), 0.0f);
+}
+
+void XpbdSolver::Pin(int particle, const glm::vec3& target) {
+  if (particle < 0 || size_t(particle) >= inverse_masses_.size()) {
+    throw std::runtime_error("Cannot pin particle " +
+                             std::to_string(particle) + "!");
+  }
+  pinned_.push_back(particle);
+  pin_targets_.push_back(target);
+  inverse_masses_[particle] = 0.0f;
+}
+
+void XpbdSolver::ClearPins() {
+  pinned_.clear();
+  pin_targets_.clear();
+  UpdateInverseMasses();
+}
+
+void XpbdSolver::UpdateInverseMasses() {
+  inverse_masses_.resize(masses_.size());
+  for (size_t i = 0; i < masses_.size(); i++) {
+    inverse_masses_[i] = masses_[i] > 0.0f ? 1.0f / masses_[i] : 0.0f;
+  }
+  for (int particle : pinned_) {
+    inverse_masses_[particle] = 0.0f;
+  }
+}
+
+template <class TKernel>
+void XpbdSolver::ForEachParticle(size_t count, const TKernel& kernel) {
+  if (thread_pool_ == nullptr) {
+    kernel(0, count);
+  } else {
+    thread_pool_->ParallelFor(count, 4096, std::cref(kernel));
+  }
+}
+
+void XpbdSolver::Step(ParticleState& state, float dt) {
+  size_t n = inverse_masses_.size();
+  if (state.positions.size() != n || state.velocities.size() != n ||
+      (!external_forces_.empty() && external_forces_.size() != n)) {
+    throw std::runtime_error(
+        "Cannot step a particle state with inconsistent sizes!");
+  }
+  predicted_.resize(n);
+  float h = dt / substeps_;
+  for (size_t i = 0; i < n; i++) {
+    /* exact decay of v' = -drag/m v over one substep, stable for any h */
+    drag_rates_[i] = std::exp(-drag_const_ * inverse_masses_[i] * h);
+  }
+
+  for (int substep = 0; substep < substeps_; substep++) {
+    ForEachParticle(n, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        if (inverse_masses_[i] == 0.0f) {
+          predicted_[i] = state.positions[i];
+          continue;
+        }
+        glm::vec3& v = state.velocities[i];
+        v.y -= 9.81f * h;
+        if (!external_forces_.empty()) {
+          v += h * inverse_masses_[i] * external_forces_[i];
+        }
+        v *= drag_rates_[i];
+        predicted_[i] = state.positions[i] + h * v;
+      }
+    });
+
+    for (size_t k = 0; k < pinned_.size(); k++) {
+      predicted_[pinned_[k]] = pin_targets_[k];
+    }
+    ProjectConstraints(h);
+
+    ForEachParticle(n, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        state.velocities[i] = (predicted_[i] - state.positions[i]) / h;
+        state.positions[i] = predicted_[i];
+      }
+    });
+  }
+}
+
+void XpbdSolver::ProjectConstraints(float h) {
+  const int* indices = constraints_.GetIndices();
+  const float* rest_lengths = constraints_.GetRestLengths();
+  float inverse_h2 = 1.0f / (h * h);
+  /* with one pass per substep the multipliers start from zero each time */
+  std::fill(lambdas_.begin(), lambdas_.end(), 0.0f);
+
+  for (size_t c = 0; c < colouring_.GetColourCount(); c++) {
+    const uint32_t* constraints = colouring_.GetSprings(c);
+    auto project = [&](size_t begin, size_t end) {
+      for (size_t k = begin; k < end; k++) {
+        uint32_t i = constraints[k];
+        int a = indices[2 * i];
+        int b = indices[2 * i + 1];
+        float w = inverse_masses_[a] + inverse_masses_[b];
+        glm::vec3 d = predicted_[a] - predicted_[b];
+        float length = glm::length(d);
+        if (w == 0.0f || length == 0.0f) {
+          continue;
+        }
+        float alpha = compliances_[i] * inverse_h2;
+        float error = length - rest_lengths[i];
+        float delta_lambda = (-error - alpha * lambdas_[i]) / (w + alpha);
+        lambdas_[i] += delta_lambda;
+        glm::vec3 correction = (delta_lambda / length) * d;
+        predicted_[a] += inverse_masses_[a] * correction;
+        predicted_[b] -= inverse_masses_[b] * correction;
+      }
+    };
+    if (thread_pool_ == nullptr) {
+      project(0, colouring_.GetSize(c));
+    } else {
+      thread_pool_->ParallelFor(colouring_.GetSize(c), 1024, std::cref(project));
+    }
+  }
+}
+}  // namespace GLOO
@@ -0,0 +1,83 @@
+#ifndef XPBD_SOLVER_H_
+#define XPBD_SOLVER_H_
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ParticleState.hpp"
+#include "SpringColouring.hpp"
+#include "SpringNetwork.hpp"
+#include "ThreadPool.hpp"
+
+namespace GLOO {
+// Extended position based dynamics (Macklin et al., "XPBD: Position-Based
+// Simulation of Compliant Constrained Dynamics") for cloth. Each spring
+// becomes a distance constraint with compliance 1 / stiffness, so the
+// material matches the force-based model, and pinned particles get zero
+// inverse mass and follow their targets. Each step is split into substeps
+// with one projection pass each ("Small Steps in Physics Simulation").
+//
+// Constraints are projected colour by colour (see SpringColouring), so a
+// thread pool can project a colour's constraints concurrently and the
+// result does not depend on the number of threads.
+class XpbdSolver {
+ public:
+  XpbdSolver();
+
+  void SetMasses(const std::vector<float>& masses);
+  // Rest lengths and stiffnesses of the distance constraints.
+  void SetConstraints(const SpringNetwork& springs);
+  // Holds a particle at target; call after SetMasses.
+  void Pin(int particle, const glm::vec3& target);
+  void ClearPins();
+
+  // Viscous drag as in PendulumSystem: force -drag_const * velocity.
+  void SetDragConst(float drag_const) {
+    drag_const_ = drag_const;
+  }
+  // Forces held over the next steps on top of gravity and drag, one per
+  // particle; empty for none.
+  void SetExternalForces(const std::vector<glm::vec3>& forces) {
+    external_forces_ = forces;
+  }
+  void SetSubsteps(int substeps) {
+    substeps_ = substeps;
+  }
+  int GetSubsteps() const {
+    return substeps_;
+  }
+  void SetThreadPool(std::shared_ptr<ThreadPool> thread_pool) {
+    thread_pool_ = std::move(thread_pool);
+  }
+
+  // Advances positions and velocities by dt.
+  void Step(ParticleState& state, float dt);
+
+ private:
+  template <class TKernel>
+  void ForEachParticle(size_t count, const TKernel& kernel);
+  void ProjectConstraints(float h);
+  void UpdateInverseMasses();
+
+  std::vector<float> masses_;
+  std::vector<float> inverse_masses_;
+  std::vector<float> drag_rates_;
+  SpringNetwork constraints_;
+  SpringColouring colouring_;
+  std::vector<float> compliances_;
+  std::vector<float> lambdas_;
+  std::vector<int> pinned_;
+  std::vector<glm::vec3> pin_targets_;
+  std::vector<glm::vec3> external_forces_;
+
+  float drag_const_;
+  int substeps_;
+  std::shared_ptr<ThreadPool> thread_pool_;
+
+  std::vector<glm::vec3> predicted_;
+};
+}  // namespace GLOO
+
+#endif
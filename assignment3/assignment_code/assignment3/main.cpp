@@ -2,46 +2,408 @@
 #include <chrono>
 #include <string>
 #include <cstdio>
+#include <cmath>
+#include <vector>
 #include <stdexcept>
+#include <algorithm>
 
 #include "SimulationApp.hpp"
 #include "IntegratorType.hpp"
+#include "HeadlessSimulation.hpp"
+#include "Trajectory.hpp"
+#include "BatchedPendulumSystem.hpp"
+#include "FixedPendulumSystem.hpp"
+#include "IntegratorFactory.hpp"
+#include "SystemFactory.hpp"
+#include "SimulationDescription.hpp"
 
 using namespace GLOO;
 
+static int RunHeadless(int argc, char** argv) {
+  bool cloth = std::string(argv[2]) == "cloth";
+  if (!cloth && std::string(argv[2]) != "pendulum") {
+    throw std::runtime_error("Unrecognized system: " + std::string(argv[2]) + ".");
+  }
+  IntegratorType integrator_type = ParseIntegratorType(argv[3][0]);
+  float integration_step = std::stof(argv[4]);
+  double duration = std::stod(argv[5]);
+  size_t thread_count = argc >= 9 ? std::stoul(argv[8]) : 1;
+
+  HeadlessSimulation simulation(integrator_type, integration_step, cloth,
+                                thread_count);
+  std::unique_ptr<TrajectoryWriter> trajectory;
+  if (argc >= 7) {
+    TrajectoryEncoding encoding = argc >= 8 && argv[7][0] == 'q'
+                                      ? TrajectoryEncoding::Quantized16
+                                      : TrajectoryEncoding::Float32;
+    trajectory = make_unique<TrajectoryWriter>(
+        argv[6], simulation.GetState().positions.size(), encoding,
+        integration_step);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  size_t step_count = simulation.Run(duration, trajectory.get());
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start).count();
+  printf("%zu steps of %zu particles in %.3f s: %.0f steps/s\n", step_count,
+         simulation.GetState().positions.size(), seconds,
+         step_count / seconds);
+  return 0;
+}
+
+static int RunDescription(int argc, char** argv) {
+  SimulationDescription description = SimulationDescription::Load(argv[2]);
+  double duration = std::stod(argv[3]);
+  size_t thread_count = argc >= 7 ? std::stoul(argv[6]) : 1;
+
+  auto start = std::chrono::steady_clock::now();
+  HeadlessSimulation simulation(description, thread_count);
+  double build_seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start).count();
+  std::unique_ptr<TrajectoryWriter> trajectory;
+  if (argc >= 5) {
+    TrajectoryEncoding encoding = argc >= 6 && argv[5][0] == 'q'
+                                      ? TrajectoryEncoding::Quantized16
+                                      : TrajectoryEncoding::Float32;
+    trajectory = make_unique<TrajectoryWriter>(
+        argv[4], simulation.GetState().positions.size(), encoding,
+        description.step);
+  }
+
+  start = std::chrono::steady_clock::now();
+  size_t step_count = simulation.Run(duration, trajectory.get());
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start).count();
+  printf("built %zu particles in %.3f s\n",
+         simulation.GetState().positions.size(), build_seconds);
+  printf("%zu steps in %.3f s: %.0f steps/s\n", step_count, seconds,
+         step_count / seconds);
+  if (description.sleep_energy > 0.0f) {
+    printf("%zu of %zu islands awake\n",
+           simulation.GetIslands().GetAwakeIslandCount(),
+           simulation.GetIslands().GetIslandCount());
+  }
+  return 0;
+}
+
+static int RunSweep(int argc, char** argv) {
+  bool cloth = std::string(argv[2]) == "cloth";
+  if (!cloth && std::string(argv[2]) != "pendulum") {
+    throw std::runtime_error("Unrecognized system: " + std::string(argv[2]) + ".");
+  }
+  IntegratorType integrator_type = ParseIntegratorType(argv[3][0]);
+  float integration_step = std::stof(argv[4]);
+  double duration = std::stod(argv[5]);
+  size_t count = std::stoul(argv[6]);
+
+  ParticleState state;
+  PendulumSystem prototype;
+  CollisionSolver collisions; /* unused: batches have no contacts */
+  if (cloth) {
+    ClothDescription cloth;
+    state = SystemFactory::CreateClothState(cloth);
+    SystemFactory::BuildCloth(cloth, prototype, collisions);
+  } else {
+    state = SystemFactory::CreatePendulumState();
+    SystemFactory::BuildPendulum(state, prototype);
+  }
+
+  /* drag swept from half to twice the scene's */
+  BatchedPendulumSystem system(prototype, count);
+  BatchedParticleState batch;
+  batch.Resize(count, state.positions.size());
+  for (size_t lane = 0; lane < count; lane++) {
+    float t = count > 1 ? float(lane) / (count - 1) : 0.0f;
+    system.SetDragConst(lane, prototype.drag_const * (0.5f + 1.5f * t));
+    batch.SetSystem(lane, state);
+  }
+  auto integrator = IntegratorFactory::CreateIntegrator<BatchedPendulumSystem,
+                                                        BatchedParticleState>(
+      integrator_type, batch);
+
+  size_t step_count = size_t(duration / integration_step + 0.5);
+  float time = 0.0f;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < step_count; i++) {
+    integrator->Step(system, batch, time, integration_step);
+    time += integration_step;
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start).count();
+  printf("%zu systems x %zu steps in %.3f s: %.0f system-steps/s\n", count,
+         step_count, seconds, count * step_count / seconds);
+
+  ParticleState last;
+  for (size_t lane = 0; lane < count; lane += std::max<size_t>(1, count / 4)) {
+    batch.GetSystem(lane, last);
+    printf("  drag %.3f: last particle at %s\n",
+           prototype.drag_const * (0.5f + 1.5f * (count > 1 ? float(lane) / (count - 1) : 0.0f)),
+           glm::to_string(last.positions.back()).c_str());
+  }
+  return 0;
+}
+
+static int RunRigs(int argc, char** argv) {
+  IntegratorType integrator_type = ParseIntegratorType(argv[2][0]);
+  float integration_step = std::stof(argv[3]);
+  double duration = std::stod(argv[4]);
+  size_t count = std::stoul(argv[5]);
+
+  /* count copies of the 4-particle pendulum, each started at a different
+     angle, stepped once as dynamic states and once at a fixed size */
+  ParticleState state = SystemFactory::CreatePendulumState();
+  PendulumSystem system;
+  SystemFactory::BuildPendulum(state, system);
+  std::vector<ParticleState> rigs(count, state);
+  for (size_t r = 0; r < count; r++) {
+    float angle = 1.5f * float(r) / std::max<size_t>(1, count);
+    for (size_t i = 1; i < state.positions.size(); i++) {
+      glm::vec3 arm = state.positions[i] - state.positions[0];
+      rigs[r].positions[i] = state.positions[0] +
+                             glm::length(arm) * glm::vec3(std::cos(angle), -std::sin(angle), 0.0f);
+    }
+  }
+  using FixedRigState = FixedParticleState<4>;
+  using FixedRigSystem = FixedPendulumSystem<4, 3>;
+  FixedRigSystem fixed_system(system);
+  std::vector<FixedRigState> fixed_rigs(count);
+  for (size_t r = 0; r < count; r++) {
+    fixed_rigs[r] = MakeFixedState<4>(rigs[r]);
+  }
+
+  /* one integrator per rig, as each character would have: integrators
+     carry state between steps, such as Verlet's last derivative */
+  std::vector<std::unique_ptr<IntegratorBase<PendulumSystem, ParticleState>>> integrators;
+  std::vector<std::unique_ptr<IntegratorBase<FixedRigSystem, FixedRigState>>> fixed_integrators;
+  for (size_t r = 0; r < count; r++) {
+    integrators.push_back(IntegratorFactory::CreateIntegrator<PendulumSystem, ParticleState>(
+        integrator_type, rigs[r]));
+    fixed_integrators.push_back(IntegratorFactory::CreateIntegrator<FixedRigSystem, FixedRigState>(
+        integrator_type, fixed_rigs[r]));
+  }
+  size_t step_count = size_t(duration / integration_step + 0.5);
+
+  auto start = std::chrono::steady_clock::now();
+  float time = 0.0f;
+  for (size_t i = 0; i < step_count; i++) {
+    for (size_t r = 0; r < count; r++) {
+      integrators[r]->Step(system, rigs[r], time, integration_step);
+    }
+    time += integration_step;
+  }
+  double dynamic_seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  time = 0.0f;
+  for (size_t i = 0; i < step_count; i++) {
+    for (size_t r = 0; r < count; r++) {
+      fixed_integrators[r]->Step(fixed_system, fixed_rigs[r], time, integration_step);
+    }
+    time += integration_step;
+  }
+  double fixed_seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start).count();
+
+  float max_deviation = 0.0f;
+  for (size_t r = 0; r < count; r++) {
+    for (size_t i = 0; i < 4; i++) {
+      max_deviation = std::max(max_deviation,
+                               glm::length(rigs[r].positions[i] - fixed_rigs[r].positions[i]));
+    }
+  }
+  printf("%zu rigs x %zu steps\n", count, step_count);
+  printf("  dynamic: %.3f s, %.0f rig-steps/s\n", dynamic_seconds,
+         count * step_count / dynamic_seconds);
+  printf("  fixed:   %.3f s, %.0f rig-steps/s\n", fixed_seconds,
+         count * step_count / fixed_seconds);
+  printf("  max position deviation %g\n", max_deviation);
+  return 0;
+}
+
+static int RunSoA(int argc, char** argv) {
+  bool cloth = std::string(argv[2]) == "cloth";
+  if (!cloth && std::string(argv[2]) != "pendulum") {
+    throw std::runtime_error("Unrecognized system: " + std::string(argv[2]) + ".");
+  }
+  IntegratorType integrator_type = ParseIntegratorType(argv[3][0]);
+  float integration_step = std::stof(argv[4]);
+  double duration = std::stod(argv[5]);
+  size_t thread_count = argc >= 7 ? std::stoul(argv[6]) : 1;
+
+  /* the same system stepped once per layout, without contacts, which
+     only the AoS state supports */
+  ParticleState state;
+  PendulumSystem system;
+  CollisionSolver collisions;
+  if (cloth) {
+    ClothDescription description;
+    state = SystemFactory::CreateClothState(description);
+    SystemFactory::BuildCloth(description, system, collisions);
+  } else {
+    state = SystemFactory::CreatePendulumState();
+    SystemFactory::BuildPendulum(state, system);
+  }
+  if (thread_count != 1) {
+    system.SetThreadPool(std::make_shared<ThreadPool>(thread_count));
+  }
+  ParticleStateSoA soa_state(state);
+
+  auto integrator = IntegratorFactory::CreateIntegrator<PendulumSystem, ParticleState>(
+      integrator_type, state);
+  auto soa_integrator = IntegratorFactory::CreateIntegrator<PendulumSystem, ParticleStateSoA>(
+      integrator_type, soa_state);
+  size_t step_count = size_t(duration / integration_step + 0.5);
+
+  auto start = std::chrono::steady_clock::now();
+  float time = 0.0f;
+  for (size_t i = 0; i < step_count; i++) {
+    integrator->Step(system, state, time, integration_step);
+    time += integration_step;
+  }
+  double aos_seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  time = 0.0f;
+  for (size_t i = 0; i < step_count; i++) {
+    soa_integrator->Step(system, soa_state, time, integration_step);
+    time += integration_step;
+  }
+  double soa_seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start).count();
+
+  float max_deviation = 0.0f;
+  for (size_t i = 0; i < state.positions.size(); i++) {
+    max_deviation = std::max(max_deviation,
+                             glm::length(state.positions[i] - soa_state.GetPosition(i)));
+  }
+  printf("%zu steps of %zu particles\n", step_count, state.positions.size());
+  printf("  AoS: %.3f s, %.0f steps/s\n", aos_seconds, step_count / aos_seconds);
+  printf("  SoA: %.3f s, %.0f steps/s\n", soa_seconds, step_count / soa_seconds);
+  printf("  max position deviation %g\n", max_deviation);
+  return max_deviation == 0.0f ? 0 : 1;
+}
+
+static int DiffTrajectories(int argc, char** argv) {
+  TrajectoryReader a(argv[2]);
+  TrajectoryReader b(argv[3]);
+  float tolerance = argc >= 5 ? std::stof(argv[4]) : 0.0f;
+  if (a.GetParticleCount() != b.GetParticleCount()) {
+    printf("Particle counts differ: %zu vs %zu\n", a.GetParticleCount(),
+           b.GetParticleCount());
+    return 1;
+  }
+
+  double time_a, time_b;
+  ParticleState state_a, state_b;
+  size_t frame = 0, first_exceeding = 0;
+  float max_deviation = 0.0f;
+  bool exceeded = false;
+  while (true) {
+    bool more_a = a.ReadFrame(time_a, state_a);
+    bool more_b = b.ReadFrame(time_b, state_b);
+    if (more_a != more_b) {
+      printf("Frame counts differ after %zu frames\n", frame);
+      return 1;
+    }
+    if (!more_a) {
+      break;
+    }
+    for (size_t i = 0; i < state_a.positions.size(); i++) {
+      float deviation = glm::length(state_a.positions[i] - state_b.positions[i]);
+      if (deviation > tolerance && !exceeded) {
+        exceeded = true;
+        first_exceeding = frame;
+      }
+      max_deviation = std::max(max_deviation, deviation);
+    }
+    frame++;
+  }
+  printf("%zu frames, max position deviation %g\n", frame, max_deviation);
+  if (exceeded) {
+    printf("Exceeds tolerance %g first at frame %zu\n", tolerance,
+           first_exceeding);
+    return 1;
+  }
+  return 0;
+}
+
 int main(int argc, char** argv) {
-  if (argc != 3) {
-    printf("Usage: %s <e|t|r> <timestep>\n", argv[0]);
+  if (argc >= 6 && argc <= 9 && std::string(argv[1]) == "headless") {
+    return RunHeadless(argc, argv);
+  }
+  if (argc >= 4 && argc <= 7 && std::string(argv[1]) == "run") {
+    return RunDescription(argc, argv);
+  }
+  if (argc == 7 && std::string(argv[1]) == "sweep") {
+    return RunSweep(argc, argv);
+  }
+  if (argc == 6 && std::string(argv[1]) == "rigs") {
+    return RunRigs(argc, argv);
+  }
+  if ((argc == 6 || argc == 7) && std::string(argv[1]) == "soa") {
+    return RunSoA(argc, argv);
+  }
+  if ((argc == 4 || argc == 5) && std::string(argv[1]) == "diff") {
+    return DiffTrajectories(argc, argv);
+  }
+  bool scene = argc >= 3 && std::string(argv[1]) == "scene";
+  if (argc < 3 || argc > 5) {
+    printf("Usage: %s <e|t|r|i|a|s|v|x> <timestep> [threads] [async]\n", argv[0]);
     printf("       e: Integrator: Forward Euler\n");
     printf("       t: Integrator: Trapezoid\n");
     printf("       r: Integrator: RK 4\n");
+    printf("       i: Integrator: Backward Euler (implicit)\n");
+    printf("       a: Integrator: Adaptive RK45 (timestep is ignored)\n");
+    printf("       s: Integrator: Symplectic Euler\n");
+    printf("       v: Integrator: Velocity Verlet\n");
+    printf("       x: Solver: XPBD (timestep is ignored)\n");
+    printf("       threads: force evaluation threads (default 1, 0: all cores)\n");
+    printf("       async: step on a simulation thread at the fixed timestep\n");
     printf("\n");
     printf("Try  : %s t 0.001\n", argv[0]);
     printf("       for trapezoid (1ms steps)\n");
     printf("Or   : %s r 0.005\n", argv[0]);
     printf("       for RK4 (5ms steps)\n");
+    printf("Or   : %s i 0.05\n", argv[0]);
+    printf("       for backward Euler (50ms steps)\n");
+    printf("\n");
+    printf("Usage: %s headless <pendulum|cloth> <e|t|r|i|a|s|v|x> <timestep> <duration>\n", argv[0]);
+    printf("          [trajectory] [f|q] [threads]\n");
+    printf("       steps without a window as fast as possible and prints steps/s;\n");
+    printf("       f|q: store float32 (default) or 16-bit quantized frames\n");
+    printf("Usage: %s sweep <pendulum|cloth> <e|t|r|a|s|v> <timestep> <duration> <count>\n", argv[0]);
+    printf("       steps count copies, with drag from 0.5x to 2x, as one SIMD batch\n");
+    printf("Usage: %s rigs <e|t|r|i|a|s|v> <timestep> <duration> <count>\n", argv[0]);
+    printf("       steps count pendulums as dynamic and as fixed-size rigs and compares\n");
+    printf("Usage: %s soa <pendulum|cloth> <e|t|r|a|s|v> <timestep> <duration> [threads]\n", argv[0]);
+    printf("       steps the system as AoS and as SoA state, without contacts, and compares\n");
+    printf("Usage: %s scene <description> [threads] [async]\n", argv[0]);
+    printf("       shows the cloth, integrator and timestep a description file gives\n");
+    printf("Usage: %s run <description> <duration> [trajectory] [f|q] [threads]\n", argv[0]);
+    printf("       steps a description's cloth without a window\n");
+    printf("Usage: %s diff <trajectory> <trajectory> [tolerance]\n", argv[0]);
+    printf("       compares positions frame by frame\n");
     return -1;
   }
 
-  IntegratorType integrator_type;
-  switch (argv[1][0]) {
-    case 'e':
-      integrator_type = IntegratorType::Euler;
-      break;
-    case 't':
-      integrator_type = IntegratorType::Trapezoidal;
-      break;
-    case 'r':
-      integrator_type = IntegratorType::RK4;
-      break;
-    default:
-      throw std::runtime_error(
-          "Unrecognized integrator type: " + std::string(1, argv[1][0]) + ".");
+  SimulationDescription description;
+  if (scene) {
+    description = SimulationDescription::Load(argv[2]);
+  } else {
+    description.integrator = ParseIntegratorType(argv[1][0]);
+    description.step = std::stof(argv[2]);
   }
-  float integration_step = std::stof(argv[2]);
+  size_t thread_count = argc >= 4 ? std::stoul(argv[3]) : 1;
+  bool async = argc == 5 && std::string(argv[4]) == "async";
 
   std::unique_ptr<SimulationApp> app = make_unique<SimulationApp>(
-      "Assignment3", glm::ivec2(1440, 900), integrator_type, integration_step);
+      "Assignment3", glm::ivec2(1440, 900), description.integrator,
+      description.step, thread_count, async);
+  app->SetClothDescription(description.cloth);
+  app->SetSleepThreshold(description.sleep_energy, description.sleep_delay);
+  app->SetForceFields(description.fields);
 
   app->SetupScene();
 
@@ -10,12 +10,21 @@
 namespace GLOO {
 void VertexObject::UpdatePositions(std::unique_ptr<PositionArray> positions) {
   if (positions_ == nullptr) {
-    vertex_array_->CreatePositionBuffer();
+    vertex_array_->CreatePositionBuffer(usage_);
   }
   positions_ = std::move(positions);
   vertex_array_->UpdatePositions(*positions_);
 }
 
+void VertexObject::UpdatePositions(const PositionArray& positions) {
+  if (positions_ == nullptr) {
+    vertex_array_->CreatePositionBuffer(usage_);
+    positions_ = make_unique<PositionArray>();
+  }
+  *positions_ = positions;
+  vertex_array_->UpdatePositions(*positions_);
+}
+
 void VertexObject::UpdateIndices(std::unique_ptr<IndexArray> indices) {
   if (indices_ == nullptr) {
     vertex_array_->CreateIndexBuffer();
@@ -26,15 +35,50 @@ void VertexObject::UpdateIndices(std::unique_ptr<IndexArray> indices) {
 
 void VertexObject::UpdateNormals(std::unique_ptr<NormalArray> normals) {
   if (normals_ == nullptr) {
-    vertex_array_->CreateNormalBuffer();
+    vertex_array_->CreateNormalBuffer(usage_);
   }
   normals_ = std::move(normals);
   vertex_array_->UpdateNormals(*normals_);
 }
 
+void VertexObject::UpdateNormals(const NormalArray& normals) {
+  if (normals_ == nullptr) {
+    vertex_array_->CreateNormalBuffer(usage_);
+    normals_ = make_unique<NormalArray>();
+  }
+  *normals_ = normals;
+  vertex_array_->UpdateNormals(*normals_);
+}
+
+void VertexObject::UpdateInstanceOffsets(const PositionArray& offsets) {
+  if (instance_offsets_ == nullptr) {
+    vertex_array_->CreateInstanceOffsetBuffer(BufferUsage::Dynamic);
+    instance_offsets_ = make_unique<PositionArray>();
+  }
+  *instance_offsets_ = offsets;
+  vertex_array_->UpdateInstanceOffsets(*instance_offsets_);
+}
+
+void VertexObject::StreamPositions(const glm::vec3* positions,
+                                   size_t count) {
+  if (positions_ == nullptr || positions_->size() != count) {
+    throw std::runtime_error("Cannot stream positions of a different size!");
+  }
+  vertex_array_->UpdatePositions(positions, count);
+}
+
+void VertexObject::StreamInstanceOffsets(const glm::vec3* offsets,
+                                         size_t count) {
+  if (instance_offsets_ == nullptr || instance_offsets_->size() != count) {
+    throw std::runtime_error(
+        "Cannot stream instance offsets of a different size!");
+  }
+  vertex_array_->UpdateInstanceOffsets(offsets, count);
+}
+
 void VertexObject::UpdateColors(std::unique_ptr<ColorArray> colors) {
   if (colors_ == nullptr) {
-    vertex_array_->CreateColorBuffer();
+    vertex_array_->CreateColorBuffer(usage_);
   }
   colors_ = std::move(colors);
   vertex_array_->UpdateColors(*colors_);
@@ -42,7 +86,7 @@ void VertexObject::UpdateColors(std::unique_ptr<ColorArray> colors) {
 
 void VertexObject::UpdateTexCoord(std::unique_ptr<TexCoordArray> tex_coords) {
   if (tex_coords_ == nullptr) {
-    vertex_array_->CreateTexCoordBuffer();
+    vertex_array_->CreateTexCoordBuffer(usage_);
   }
   tex_coords_ = std::move(tex_coords);
   vertex_array_->UpdateTexCoords(*tex_coords_);
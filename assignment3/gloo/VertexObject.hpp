@@ -8,7 +8,11 @@ namespace GLOO {
 // for sending data from CPU to GPU via the Update* methods.
 class VertexObject {
  public:
-  VertexObject() : vertex_array_(make_unique<VertexArray>()) {
+  // Geometry rewritten every frame should use BufferUsage::Dynamic. The
+  // usage applies to vertex attributes; indices are topology and are
+  // always uploaded as static data.
+  explicit VertexObject(BufferUsage usage = BufferUsage::Static)
+      : vertex_array_(make_unique<VertexArray>()), usage_(usage) {
   }
 
   // Vertex buffers are created in a lazy manner in the following Update*.
@@ -18,6 +22,21 @@ class VertexObject {
   void UpdateTexCoord(std::unique_ptr<TexCoordArray> tex_coords);
   void UpdateIndices(std::unique_ptr<IndexArray> indices);
 
+  // Copy into the arrays already owned, reusing their storage, so that
+  // per-frame updates do not allocate.
+  void UpdatePositions(const PositionArray& positions);
+  void UpdateNormals(const NormalArray& normals);
+
+  // One offset per instance for instanced rendering; always dynamic.
+  void UpdateInstanceOffsets(const PositionArray& offsets);
+
+  // Upload straight from memory the caller owns, without the CPU copy, for
+  // data streamed every frame. The count must match the last Update*, and
+  // GetPositions() and GetInstanceOffsets() keep returning that update's
+  // values, so only geometry whose CPU copy is not read back should stream.
+  void StreamPositions(const glm::vec3* positions, size_t count);
+  void StreamInstanceOffsets(const glm::vec3* offsets, size_t count);
+
   bool HasPositions() const {
     return positions_ != nullptr;
   }
@@ -38,6 +57,10 @@ class VertexObject {
     return indices_ != nullptr;
   }
 
+  bool HasInstanceOffsets() const {
+    return instance_offsets_ != nullptr;
+  }
+
   const PositionArray& GetPositions() const {
     if (positions_ == nullptr)
       throw std::runtime_error("No position in VertexObject!");
@@ -68,6 +91,12 @@ class VertexObject {
     return *indices_;
   }
 
+  const PositionArray& GetInstanceOffsets() const {
+    if (instance_offsets_ == nullptr)
+      throw std::runtime_error("No instance offsets in VertexObject!");
+    return *instance_offsets_;
+  }
+
   VertexArray& GetVertexArray() {
     return *vertex_array_.get();
   }
@@ -77,6 +106,7 @@ class VertexObject {
 
  private:
   std::unique_ptr<VertexArray> vertex_array_;
+  BufferUsage usage_;
 
   // Owner of vertex data.
   std::unique_ptr<PositionArray> positions_;
@@ -84,6 +114,7 @@ class VertexObject {
   std::unique_ptr<ColorArray> colors_;
   std::unique_ptr<TexCoordArray> tex_coords_;
   std::unique_ptr<IndexArray> indices_;
+  std::unique_ptr<PositionArray> instance_offsets_;
 };
 
 }  // namespace GLOO
@@ -0,0 +1,38 @@
+#include "InstancedRenderingComponent.hpp"
+
+#include <stdexcept>
+
+namespace GLOO {
+InstancedRenderingComponent::InstancedRenderingComponent(
+    std::shared_ptr<VertexObject> vertex_obj)
+    : RenderingComponent(std::move(vertex_obj)) {
+  vertex_obj_->UpdateInstanceOffsets(PositionArray());
+}
+
+void InstancedRenderingComponent::SetInstanceOffsets(
+    const PositionArray& offsets) {
+  vertex_obj_->UpdateInstanceOffsets(offsets);
+}
+
+void InstancedRenderingComponent::StreamInstanceOffsets(
+    const glm::vec3* offsets,
+    size_t count) {
+  vertex_obj_->StreamInstanceOffsets(offsets, count);
+}
+
+void InstancedRenderingComponent::Render() const {
+  if (vertex_obj_ == nullptr) {
+    throw std::runtime_error(
+        "Rendering component has no vertex object attached!");
+  }
+  size_t instance_count = vertex_obj_->GetInstanceOffsets().size();
+  if (instance_count == 0) {
+    return;
+  }
+  size_t num_indices = vertex_obj_->HasIndices()
+                           ? vertex_obj_->GetIndices().size()
+                           : vertex_obj_->GetPositions().size();
+  vertex_obj_->GetVertexArray().RenderInstanced(0, num_indices,
+                                                instance_count);
+}
+}  // namespace GLOO
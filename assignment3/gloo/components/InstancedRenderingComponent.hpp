@@ -0,0 +1,25 @@
+#ifndef GLOO_INSTANCED_RENDERING_COMPONENT_H_
+#define GLOO_INSTANCED_RENDERING_COMPONENT_H_
+
+#include "RenderingComponent.hpp"
+
+namespace GLOO {
+// Draws one copy of the vertex object per instance offset in a single draw
+// call. It takes the place of the node's RenderingComponent, and needs a
+// shader that reads the offsets, such as InstancedPhongShader.
+class InstancedRenderingComponent : public RenderingComponent {
+ public:
+  InstancedRenderingComponent(std::shared_ptr<VertexObject> vertex_obj);
+  // Offsets are in the node's local space, one per instance.
+  void SetInstanceOffsets(const PositionArray& offsets);
+  // Same number of offsets as last set, uploaded from the caller's memory.
+  void StreamInstanceOffsets(const glm::vec3* offsets, size_t count);
+
+  void Render() const override;
+};
+
+CREATE_COMPONENT_TRAIT(InstancedRenderingComponent, ComponentType::Rendering);
+
+}  // namespace GLOO
+
+#endif
@@ -17,9 +17,9 @@ class RenderingComponent : public ComponentBase {
     return vertex_obj_.get();
   }
 
-  void Render() const;
+  virtual void Render() const;
 
- private:
+ protected:
   std::shared_ptr<VertexObject> vertex_obj_;
   int start_index_;
   int num_indices_;
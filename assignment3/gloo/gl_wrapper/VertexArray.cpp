@@ -25,6 +25,7 @@ VertexArray::VertexArray(VertexArray&& other) noexcept {
   color_buf_ = std::move(other.color_buf_);
   tex_coord_buf_ = std::move(other.tex_coord_buf_);
   idx_buf_ = std::move(other.idx_buf_);
+  instance_offset_buf_ = std::move(other.instance_offset_buf_);
   draw_mode_ = other.draw_mode_;
   polygon_mode_ = other.polygon_mode_;
 }
@@ -38,11 +39,23 @@ VertexArray& VertexArray::operator=(VertexArray&& other) noexcept {
   color_buf_ = std::move(other.color_buf_);
   tex_coord_buf_ = std::move(other.tex_coord_buf_);
   idx_buf_ = std::move(other.idx_buf_);
+  instance_offset_buf_ = std::move(other.instance_offset_buf_);
   draw_mode_ = other.draw_mode_;
   polygon_mode_ = other.polygon_mode_;
   return *this;
 }
 
+static GLenum ToGLUsage(BufferUsage usage) {
+  switch (usage) {
+    case BufferUsage::Dynamic:
+      return GL_DYNAMIC_DRAW;
+    case BufferUsage::Stream:
+      return GL_STREAM_DRAW;
+    default:
+      return GL_STATIC_DRAW;
+  }
+}
+
 void VertexArray::Bind() const {
   GL_CHECK(glBindVertexArray(handle_));
 }
@@ -51,29 +64,33 @@ void VertexArray::Unbind() const {
   GL_CHECK(glBindVertexArray(0));
 }
 
-void VertexArray::CreatePositionBuffer() {
-  pos_buf_ = make_unique<PositionBuffer>(GL_STATIC_DRAW);
+void VertexArray::CreatePositionBuffer(BufferUsage usage) {
+  pos_buf_ = make_unique<PositionBuffer>(ToGLUsage(usage));
 }
 
-void VertexArray::CreateNormalBuffer() {
-  normal_buf_ = make_unique<NormalBuffer>(GL_STATIC_DRAW);
+void VertexArray::CreateNormalBuffer(BufferUsage usage) {
+  normal_buf_ = make_unique<NormalBuffer>(ToGLUsage(usage));
 }
 
-void VertexArray::CreateColorBuffer() {
-  color_buf_ = make_unique<ColorBuffer>(GL_STATIC_DRAW);
+void VertexArray::CreateColorBuffer(BufferUsage usage) {
+  color_buf_ = make_unique<ColorBuffer>(ToGLUsage(usage));
 }
 
-void VertexArray::CreateTexCoordBuffer() {
-  tex_coord_buf_ = make_unique<TexCoordBuffer>(GL_STATIC_DRAW);
+void VertexArray::CreateTexCoordBuffer(BufferUsage usage) {
+  tex_coord_buf_ = make_unique<TexCoordBuffer>(ToGLUsage(usage));
 }
 
-void VertexArray::CreateIndexBuffer() {
-  idx_buf_ = make_unique<IndexBuffer>(GL_STATIC_DRAW);
+void VertexArray::CreateIndexBuffer(BufferUsage usage) {
+  idx_buf_ = make_unique<IndexBuffer>(ToGLUsage(usage));
   BindGuard vao_bg(this);
   // Different from other types of vertex buffers, EBOs should not be unbounded.
   idx_buf_->Bind();
 }
 
+void VertexArray::CreateInstanceOffsetBuffer(BufferUsage usage) {
+  instance_offset_buf_ = make_unique<PositionBuffer>(ToGLUsage(usage));
+}
+
 void VertexArray::UpdatePositions(const PositionArray& positions) const {
   pos_buf_->Update(positions);
 }
@@ -94,6 +111,20 @@ void VertexArray::UpdateIndices(const IndexArray& indices) const {
   idx_buf_->Update(indices);
 }
 
+void VertexArray::UpdateInstanceOffsets(const PositionArray& offsets) const {
+  instance_offset_buf_->Update(offsets);
+}
+
+void VertexArray::UpdatePositions(const glm::vec3* positions,
+                                  size_t count) const {
+  pos_buf_->Update(positions, count);
+}
+
+void VertexArray::UpdateInstanceOffsets(const glm::vec3* offsets,
+                                        size_t count) const {
+  instance_offset_buf_->Update(offsets, count);
+}
+
 void VertexArray::LinkPositionBuffer(GLuint attr_idx) const {
   BindGuard vao_bg(this);
   BindGuard buf_bg(pos_buf_.get());
@@ -126,6 +157,15 @@ void VertexArray::LinkTexCoordBuffer(GLuint attr_idx) const {
   GL_CHECK(glEnableVertexAttribArray(attr_idx));
 }
 
+void VertexArray::LinkInstanceOffsetBuffer(GLuint attr_idx) const {
+  BindGuard vao_bg(this);
+  BindGuard buf_bg(instance_offset_buf_.get());
+  GL_CHECK(glVertexAttribPointer(attr_idx, 3, GL_FLOAT, GL_FALSE, 0, 0));
+  GL_CHECK(glEnableVertexAttribArray(attr_idx));
+  // Advance the attribute once per instance rather than once per vertex.
+  GL_CHECK(glVertexAttribDivisor(attr_idx, 1));
+}
+
 void VertexArray::SetDrawMode(DrawMode mode) {
   draw_mode_ = mode;
 }
@@ -167,6 +207,31 @@ void VertexArray::Render() const {
   }
 }
 
+void VertexArray::RenderInstanced(size_t start_index,
+                                  size_t num_indices,
+                                  size_t instance_count) const {
+  BindGuard vao_bg(this);
+
+  if (polygon_mode_ == PolygonMode::Wireframe) {
+    GL_CHECK(glPolygonMode(GL_FRONT_AND_BACK, GL_LINE));
+  } else {
+    GL_CHECK(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
+  }
+
+  GLint draw_mode = draw_mode_ == DrawMode::Triangles ? GL_TRIANGLES : GL_LINES;
+
+  if (idx_buf_ != nullptr) {
+    GL_CHECK(glDrawElementsInstanced(
+        draw_mode, static_cast<GLsizei>(num_indices), GL_UNSIGNED_INT,
+        reinterpret_cast<void*>(start_index * sizeof(unsigned int)),
+        static_cast<GLsizei>(instance_count)));
+  } else {
+    GL_CHECK(glDrawArraysInstanced(draw_mode, (GLint)start_index,
+                                   (GLsizei)num_indices,
+                                   (GLsizei)instance_count));
+  }
+}
+
 static_assert(std::is_move_constructible<VertexArray>(), "");
 static_assert(std::is_move_assignable<VertexArray>(), "");
 
@@ -12,6 +12,9 @@ enum class DrawMode { Triangles, Lines };
 
 enum class PolygonMode { Wireframe, Fill };
 
+// Static data is uploaded once; dynamic data is updated in place every frame.
+enum class BufferUsage { Static, Dynamic, Stream };
+
 class VertexArray : public IBindable {
  public:
   VertexArray();
@@ -27,20 +30,26 @@ class VertexArray : public IBindable {
   void Bind() const override;
   void Unbind() const override;
 
-  void CreatePositionBuffer();
-  void CreateNormalBuffer();
-  void CreateColorBuffer();
-  void CreateTexCoordBuffer();
-  void CreateIndexBuffer();
+  void CreatePositionBuffer(BufferUsage usage = BufferUsage::Static);
+  void CreateNormalBuffer(BufferUsage usage = BufferUsage::Static);
+  void CreateColorBuffer(BufferUsage usage = BufferUsage::Static);
+  void CreateTexCoordBuffer(BufferUsage usage = BufferUsage::Static);
+  void CreateIndexBuffer(BufferUsage usage = BufferUsage::Static);
+  // Per-instance offsets, advanced once per instance in instanced draws.
+  void CreateInstanceOffsetBuffer(BufferUsage usage = BufferUsage::Dynamic);
   void UpdatePositions(const PositionArray& positions) const;
   void UpdateNormals(const NormalArray& normals) const;
   void UpdateColors(const ColorArray& colors) const;
   void UpdateTexCoords(const TexCoordArray& tex_coords) const;
   void UpdateIndices(const IndexArray& indices) const;
+  void UpdateInstanceOffsets(const PositionArray& offsets) const;
+  void UpdatePositions(const glm::vec3* positions, size_t count) const;
+  void UpdateInstanceOffsets(const glm::vec3* offsets, size_t count) const;
   void LinkPositionBuffer(GLuint attr_idx) const;
   void LinkNormalBuffer(GLuint attr_idx) const;
   void LinkColorBuffer(GLuint attr_idx) const;
   void LinkTexCoordBuffer(GLuint attr_idx) const;
+  void LinkInstanceOffsetBuffer(GLuint attr_idx) const;
 
   bool HasPositionBuffer() const {
     return pos_buf_ != nullptr;
@@ -62,10 +71,18 @@ class VertexArray : public IBindable {
     return idx_buf_ != nullptr;
   }
 
+  bool HasInstanceOffsetBuffer() const {
+    return instance_offset_buf_ != nullptr;
+  }
+
   void SetDrawMode(DrawMode mode);
   void SetPolygonMode(PolygonMode mode);
   void Render(size_t start_index, size_t num_indices) const;
   void Render() const;
+  // Draws instance_count copies in a single draw call.
+  void RenderInstanced(size_t start_index,
+                       size_t num_indices,
+                       size_t instance_count) const;
 
  private:
   // Buffers are invisible to the outside.
@@ -80,6 +97,7 @@ class VertexArray : public IBindable {
   std::unique_ptr<ColorBuffer> color_buf_;
   std::unique_ptr<TexCoordBuffer> tex_coord_buf_;
   std::unique_ptr<IndexBuffer> idx_buf_;
+  std::unique_ptr<PositionBuffer> instance_offset_buf_;
 
   DrawMode draw_mode_;
   PolygonMode polygon_mode_;
@@ -15,27 +15,42 @@ template <class T, GLenum target>
 class VertexBuffer : public BindableBuffer {
  public:
   VertexBuffer(GLenum usage);
+  // Static buffers are reallocated on every update. Dynamic and stream
+  // buffers keep their storage and are overwritten in place while the data
+  // still fits, so per-frame updates do not reallocate on the GPU.
   void Update(const std::vector<T>& array);
+  // The same from count elements at data, e.g. memory owned elsewhere.
+  void Update(const T* data, size_t count);
   size_t GetSize() const {
     return size_;
   }
 
  private:
   size_t size_;
+  size_t capacity_;
   GLenum usage_;
 };
 
 template <class T, GLenum target>
 VertexBuffer<T, target>::VertexBuffer(GLenum usage)
-    : BindableBuffer(target), usage_(usage) {
+    : BindableBuffer(target), size_(0), capacity_(0), usage_(usage) {
 }
 
 template <class T, GLenum target>
 void VertexBuffer<T, target>::Update(const std::vector<T>& array) {
+  Update(array.data(), array.size());
+}
+
+template <class T, GLenum target>
+void VertexBuffer<T, target>::Update(const T* data, size_t count) {
   BindGuard bg(this);
-  GL_CHECK(
-      glBufferData(target_, sizeof(T) * array.size(), array.data(), usage_));
-  size_ = array.size();
+  if (usage_ != GL_STATIC_DRAW && count <= capacity_) {
+    GL_CHECK(glBufferSubData(target_, 0, sizeof(T) * count, data));
+  } else {
+    GL_CHECK(glBufferData(target_, sizeof(T) * count, data, usage_));
+    capacity_ = count;
+  }
+  size_ = count;
 }
 }  // namespace GLOO
 
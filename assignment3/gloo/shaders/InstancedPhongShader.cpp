@@ -0,0 +1,29 @@
+#include "InstancedPhongShader.hpp"
+
+#include <stdexcept>
+
+#include "gloo/components/RenderingComponent.hpp"
+#include "gloo/SceneNode.hpp"
+
+namespace GLOO {
+InstancedPhongShader::InstancedPhongShader()
+    : PhongShader(std::unordered_map<GLenum, std::string>{
+          {GL_VERTEX_SHADER, "phong_instanced.vert"},
+          {GL_FRAGMENT_SHADER, "phong.frag"}}) {
+}
+
+void InstancedPhongShader::SetTargetNode(const SceneNode& node,
+                                         const glm::mat4& model_matrix) const {
+  PhongShader::SetTargetNode(node, model_matrix);
+
+  VertexArray& vertex_array = node.GetComponentPtr<RenderingComponent>()
+                                  ->GetVertexObjectPtr()
+                                  ->GetVertexArray();
+  if (!vertex_array.HasInstanceOffsetBuffer()) {
+    throw std::runtime_error(
+        "Instanced Phong shader requires instance offsets!");
+  }
+  vertex_array.LinkInstanceOffsetBuffer(
+      GetAttributeLocation("instance_offset"));
+}
+}  // namespace GLOO
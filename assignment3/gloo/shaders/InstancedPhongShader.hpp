@@ -0,0 +1,17 @@
+#ifndef GLOO_INSTANCED_PHONG_SHADER_H_
+#define GLOO_INSTANCED_PHONG_SHADER_H_
+
+#include "PhongShader.hpp"
+
+namespace GLOO {
+// Phong shading for InstancedRenderingComponent: each instance is the mesh
+// translated by its offset.
+class InstancedPhongShader : public PhongShader {
+ public:
+  InstancedPhongShader();
+  void SetTargetNode(const SceneNode& node,
+                     const glm::mat4& model_matrix) const override;
+};
+}  // namespace GLOO
+
+#endif
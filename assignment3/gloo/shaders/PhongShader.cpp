@@ -21,6 +21,11 @@ PhongShader::PhongShader()
           {GL_FRAGMENT_SHADER, "phong.frag"}}) {
 }
 
+PhongShader::PhongShader(
+    const std::unordered_map<GLenum, std::string>& shader_filenames)
+    : ShaderProgram(shader_filenames) {
+}
+
 void PhongShader::AssociateVertexArray(VertexArray& vertex_array) const {
   if (!vertex_array.HasPositionBuffer()) {
     throw std::runtime_error("Phong shader requires vertex positions!");
@@ -12,6 +12,9 @@ class PhongShader : public ShaderProgram {
   void SetCamera(const CameraComponent& camera) const override;
   void SetLightSource(const LightComponent& componentt) const override;
 
+ protected:
+  // For variants that swap in their own shader stages.
+  PhongShader(const std::unordered_map<GLenum, std::string>& shader_filenames);
 
  private:
   void AssociateVertexArray(VertexArray& vertex_array) const;
@@ -32,6 +32,20 @@ ArgParser::ArgParser(int argc, const char* argv[]) {
       bounces = atoi(argv[i]);
     } else if (!strcmp(argv[i], "-shadows")) {
       shadows = true;
+    } else if (!strcmp(argv[i], "-light_samples")) {
+      i++;
+      assert(i < argc);
+      light_samples = atoi(argv[i]);
+    } else if (!strcmp(argv[i], "-preview")) {
+      preview = true;
+    } else if (!strcmp(argv[i], "-preview_passes")) {
+      i++;
+      assert(i < argc);
+      preview_passes = atoi(argv[i]);
+    } else if (!strcmp(argv[i], "-preview_frames")) {
+      i++;
+      assert(i < argc);
+      preview_frames = atoi(argv[i]);
     } else {
       printf("Unknown command line argument %d: '%s'\n", i, argv[i]);
       exit(1);
@@ -45,6 +59,12 @@ ArgParser::ArgParser(int argc, const char* argv[]) {
   std::cout << "- height: " << height << std::endl;
   std::cout << "- bounces: " << bounces << std::endl;
   std::cout << "- shadows: " << shadows << std::endl;
+  std::cout << "- light samples: " << light_samples << std::endl;
+  std::cout << "- preview: " << preview << std::endl;
+  if (preview) {
+    std::cout << "- preview passes: " << preview_passes << std::endl;
+    std::cout << "- preview frames: " << preview_frames << std::endl;
+  }
 }
 
 void ArgParser::SetDefaultValues() {
@@ -56,4 +76,9 @@ void ArgParser::SetDefaultValues() {
 
   bounces = 0;
   shadows = false;
+  light_samples = 0;
+
+  preview = false;
+  preview_passes = 16;
+  preview_frames = 0;
 }
@@ -19,6 +19,15 @@ class ArgParser {
   float depth_max;
   size_t bounces;
   bool shadows;
+  // Point lights sampled per hit; 0 shades every light.
+  size_t light_samples;
+
+  // Interactive progressive preview.
+  bool preview;
+  size_t preview_passes;
+  // Frames to run before closing the preview; 0 runs until the window is
+  // closed.
+  size_t preview_frames;
 
   // Supersampling.
   bool jitter;
@@ -15,7 +15,10 @@ struct HitRecord {
   }
 
   float time;
+  // Shading normal, possibly interpolated across the surface.
   glm::vec3 normal;
+  // True surface normal; secondary rays are offset along it.
+  glm::vec3 geometric_normal;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const HitRecord& rec) {
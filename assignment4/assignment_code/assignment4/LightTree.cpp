@@ -0,0 +1,140 @@
+#include "LightTree.hpp"
+
+#include <algorithm>
+
+#include "gloo/SceneNode.hpp"
+#include "gloo/lights/PointLight.hpp"
+
+namespace GLOO {
+void LightTree::Build(const std::vector<LightComponent*>& light_components) {
+  nodes_.clear();
+
+  std::vector<LightEntry> entries;
+  for (size_t i = 0; i < light_components.size(); i++) {
+    auto light_ptr = light_components[i]->GetLightPtr();
+    if (light_ptr->GetType() != LightType::Point)
+      continue;
+    auto point_light_ptr = static_cast<PointLight*>(light_ptr);
+
+    // Matches the falloff in Illuminator: color / (attenuation * d^2).
+    glm::vec3 color = point_light_ptr->GetDiffuseColor();
+    float luminance = 0.2126f * color.r + 0.7152f * color.g + 0.0722f * color.b;
+    float power = luminance / point_light_ptr->GetAttenuation().x;
+
+    LightEntry entry;
+    entry.position =
+        light_components[i]->GetNodePtr()->GetTransform().GetPosition();
+    entry.power = power;
+    entry.light = light_components[i];
+    entries.push_back(entry);
+  }
+
+  if (entries.empty())
+    return;
+  nodes_.reserve(2 * entries.size() - 1);
+  BuildNode(entries, 0, entries.size());
+}
+
+int LightTree::BuildNode(std::vector<LightEntry>& entries,
+                         size_t begin,
+                         size_t end) {
+  int index = nodes_.size();
+  nodes_.emplace_back();
+
+  AABB bbox(entries[begin].position, entries[begin].position);
+  float power = 0.0f;
+  for (size_t i = begin; i < end; i++) {
+    bbox.UnionWith(AABB(entries[i].position, entries[i].position));
+    power += entries[i].power;
+  }
+
+  LightNode node;
+  node.bbox = bbox;
+  node.power = power;
+  node.child[0] = node.child[1] = -1;
+  node.light = nullptr;
+
+  if (end - begin == 1) {
+    node.light = entries[begin].light;
+  } else {
+    // Median split along the longest axis of the light positions.
+    glm::vec3 extent = bbox.mx - bbox.mn;
+    int axis = 0;
+    if (extent[1] > extent[axis])
+      axis = 1;
+    if (extent[2] > extent[axis])
+      axis = 2;
+    size_t mid = (begin + end) / 2;
+    std::nth_element(entries.begin() + begin, entries.begin() + mid,
+                     entries.begin() + end,
+                     [axis](const LightEntry& a, const LightEntry& b) {
+                       return a.position[axis] < b.position[axis];
+                     });
+    node.child[0] = BuildNode(entries, begin, mid);
+    node.child[1] = BuildNode(entries, mid, end);
+  }
+
+  nodes_[index] = node;
+  return index;
+}
+
+float LightTree::Importance(const LightNode& node,
+                            const glm::vec3& position,
+                            const glm::vec3& normal,
+                            const glm::vec3& lobe) const {
+  // A cluster entirely below the surface's tangent plane gets no diffuse
+  // light, and entirely behind the plane across the lobe no specular; the
+  // half-spaces are convex, so testing the corners is conservative.
+  bool visible = lobe == glm::vec3(0.0f);
+  for (int corner = 0; corner < 8 && !visible; corner++) {
+    glm::vec3 p(corner & 4 ? node.bbox.mx.x : node.bbox.mn.x,
+                corner & 2 ? node.bbox.mx.y : node.bbox.mn.y,
+                corner & 1 ? node.bbox.mx.z : node.bbox.mn.z);
+    visible = glm::dot(p - position, normal) > 0 ||
+              glm::dot(p - position, lobe) > 0;
+  }
+  if (!visible)
+    return 0.0f;
+
+  // Treat the cluster as a single light at its center; the distance is
+  // clamped to the cluster radius so nearby clusters do not blow up.
+  glm::vec3 center = 0.5f * (node.bbox.mn + node.bbox.mx);
+  glm::vec3 half_extent = 0.5f * (node.bbox.mx - node.bbox.mn);
+  float dist2 = glm::dot(position - center, position - center);
+  float radius2 = glm::dot(half_extent, half_extent);
+  return node.power / std::max(dist2, std::max(radius2, 1e-4f));
+}
+
+const LightComponent* LightTree::Sample(const glm::vec3& position,
+                                        const glm::vec3& normal,
+                                        const glm::vec3& lobe,
+                                        float u,
+                                        float& pdf) const {
+  pdf = 1.0f;
+  if (nodes_.empty())
+    return nullptr;
+
+  int index = 0;
+  while (nodes_[index].child[0] != -1) {
+    const LightNode& left = nodes_[nodes_[index].child[0]];
+    const LightNode& right = nodes_[nodes_[index].child[1]];
+    float importance_left = Importance(left, position, normal, lobe);
+    float importance_right = Importance(right, position, normal, lobe);
+    float total = importance_left + importance_right;
+    float p_left = total > 0 ? importance_left / total : 0.5f;
+
+    // Reuse u for the next level by rescaling it into [0, 1).
+    if (u < p_left) {
+      u = u / p_left;
+      pdf *= p_left;
+      index = nodes_[index].child[0];
+    } else {
+      u = (u - p_left) / (1.0f - p_left);
+      pdf *= 1.0f - p_left;
+      index = nodes_[index].child[1];
+    }
+    u = std::min(u, 0.99999994f);
+  }
+  return nodes_[index].light;
+}
+}  // namespace GLOO
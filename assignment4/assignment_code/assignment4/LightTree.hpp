@@ -0,0 +1,63 @@
+#ifndef LIGHT_TREE_H_
+#define LIGHT_TREE_H_
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "gloo/components/LightComponent.hpp"
+
+#include "Octree.hpp"
+
+namespace GLOO {
+// Binary tree over the point lights of a scene, used to pick a few lights
+// per shading point with probability roughly proportional to how much each
+// one contributes there, instead of looping over every light.
+class LightTree {
+ public:
+  // Only point lights are kept; other light types should be shaded directly.
+  void Build(const std::vector<LightComponent*>& light_components);
+
+  bool IsEmpty() const {
+    return nodes_.empty();
+  }
+
+  // Picks a point light for a surface at position with the given normal,
+  // using a uniform random number u in [0, 1). The probability with which
+  // it was picked is returned in pdf. Only lights behind both the tangent
+  // plane and the plane across lobe (the specular reflection direction)
+  // are never picked, as neither the diffuse nor the specular term can see
+  // them; a zero lobe keeps every light.
+  const LightComponent* Sample(const glm::vec3& position,
+                               const glm::vec3& normal,
+                               const glm::vec3& lobe,
+                               float u,
+                               float& pdf) const;
+
+ private:
+  struct LightNode {
+    AABB bbox;
+    // Intensity of the node's lights at unit distance, summed.
+    float power;
+    // Children are indices into nodes_; leaves have child[0] == -1.
+    int child[2];
+    const LightComponent* light;
+  };
+
+  struct LightEntry {
+    glm::vec3 position;
+    float power;
+    const LightComponent* light;
+  };
+
+  int BuildNode(std::vector<LightEntry>& entries, size_t begin, size_t end);
+  float Importance(const LightNode& node,
+                   const glm::vec3& position,
+                   const glm::vec3& normal,
+                   const glm::vec3& lobe) const;
+
+  std::vector<LightNode> nodes_;
+};
+}  // namespace GLOO
+
+#endif
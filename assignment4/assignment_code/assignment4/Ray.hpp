@@ -30,12 +30,12 @@ class Ray {
   }
 
   void ApplyTransform(const glm::mat4& transform) {
-    glm::vec3 ref = At(1.0f);
     glm::vec4 new_origin = transform * glm::vec4(origin_, 1.0f);
     origin_ = glm::vec3(new_origin / new_origin.w);
-    glm::vec4 new_ref = transform * glm::vec4(ref, 1.0f);
-    ref = glm::vec3(new_ref / new_ref.w);
-    direction_ = ref - origin_;
+    // For affine transforms At(1.0) maps to At(1.0) when the direction is
+    // transformed as a vector. Subtracting two transformed points instead
+    // would cancel away most of the direction's precision far from origin.
+    direction_ = glm::vec3(transform * glm::vec4(direction_, 0.0f));
     // Note: do not normalize direction_ here since we want
     // ref to always be At(1.0) before/after transform.
   }
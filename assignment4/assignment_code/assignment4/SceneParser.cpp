@@ -21,6 +21,9 @@
 #include "hittable/Plane.hpp"
 #include "hittable/Triangle.hpp"
 #include "hittable/Mesh.hpp"
+#include "hittable/Box.hpp"
+#include "hittable/Cylinder.hpp"
+#include "hittable/Quad.hpp"
 
 namespace GLOO {
 SceneParser::SceneParser() {
@@ -326,6 +329,51 @@ void SceneParser::ParseTracingComponent(SceneNode& node) {
     Assert(token, "}");
     glm::vec3 n = glm::normalize(glm::cross(v1 - v0, v2 - v0));
     object = std::make_shared<Triangle>(v0, v1, v2, n, n, n);
+  } else if (type == "box") {
+    glm::vec3 mn(-1.0f), mx(1.0f);
+    while (true) {
+      fs_ >> token;
+      if (token == "min") {
+        mn = ReadVec3();
+      } else if (token == "max") {
+        mx = ReadVec3();
+      } else if (token == "}") {
+        break;
+      } else {
+        throw std::runtime_error("Bad box token: " + token + "!");
+      }
+    }
+    object = std::make_shared<Box>(mn, mx);
+  } else if (type == "cylinder") {
+    float radius = 1.0f;
+    float height = 2.0f;
+    while (true) {
+      fs_ >> token;
+      if (token == "radius") {
+        radius = ReadFloat();
+      } else if (token == "height") {
+        height = ReadFloat();
+      } else if (token == "}") {
+        break;
+      } else {
+        throw std::runtime_error("Bad cylinder token: " + token + "!");
+      }
+    }
+    object = std::make_shared<Cylinder>(radius, height);
+  } else if (type == "quad") {
+    glm::vec3 corner, edge0, edge1;
+    fs_ >> token;
+    Assert(token, "corner");
+    corner = ReadVec3();
+    fs_ >> token;
+    Assert(token, "edge0");
+    edge0 = ReadVec3();
+    fs_ >> token;
+    Assert(token, "edge1");
+    edge1 = ReadVec3();
+    fs_ >> token;
+    Assert(token, "}");
+    object = std::make_shared<Quad>(corner, edge0, edge1);
   } else if (type == "mesh") {
     std::string filename;
     fs_ >> token;
@@ -3,6 +3,8 @@
 #include <glm/gtx/string_cast.hpp>
 #include <stdexcept>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 #include "gloo/Transform.hpp"
 #include "gloo/components/MaterialComponent.hpp"
@@ -11,28 +13,53 @@
 #include "gloo/Image.hpp"
 #include "Illuminator.hpp"
 
-namespace GLOO {
-void Tracer::Render(const Scene& scene, const std::string& output_file) {
-  scene_ptr_ = &scene;
+namespace {
+// Rounding error of a world-space hit point, in units of float epsilon
+// relative to the magnitudes involved. It covers origin + t * direction
+// plus the error the object-space intersection and the transforms around
+// it leave in t.
+const float kHitErrorEpsilons = 64.0f;
 
-  auto& root = scene_ptr_->GetRootNode();
-  tracing_components_ = root.GetComponentPtrsInChildren<TracingComponent>();
-  light_components_ = root.GetComponentPtrsInChildren<LightComponent>();
+glm::vec3 HitPointError(const GLOO::Ray& ray, float t) {
+  return kHitErrorEpsilons * std::numeric_limits<float>::epsilon() *
+         (glm::abs(ray.GetOrigin()) + glm::abs(t * ray.GetDirection()));
+}
 
+// Pushes p along the geometric normal, to the side direction leaves
+// through, by just more than its error bound, so a ray spawned there cannot
+// re-hit the surface it starts on. Unlike a fixed epsilon this scales with
+// the magnitude of the coordinates.
+glm::vec3 OffsetRayOrigin(const glm::vec3& p,
+                          const glm::vec3& p_error,
+                          const glm::vec3& normal,
+                          const glm::vec3& direction) {
+  float d = glm::dot(glm::abs(normal), p_error);
+  glm::vec3 offset = d * normal;
+  if (glm::dot(direction, normal) < 0) {
+    offset = -offset;
+  }
+  glm::vec3 origin = p + offset;
+  // Round away from p so the offset is not lost in the addition.
+  for (int dim = 0; dim < 3; dim++) {
+    if (offset[dim] > 0) {
+      origin[dim] = std::nextafter(origin[dim], std::numeric_limits<float>::max());
+    } else if (offset[dim] < 0) {
+      origin[dim] = std::nextafter(origin[dim], -std::numeric_limits<float>::max());
+    }
+  }
+  return origin;
+}
+}  // namespace
+
+namespace GLOO {
+void Tracer::Render(const Scene& scene, const std::string& output_file) {
+  Prepare(scene);
 
   Image image(image_size_.x, image_size_.y);
 
   for (size_t y = 0; y < image_size_.y; y++) {
     for (size_t x = 0; x < image_size_.x; x++) {
-
-      float i = (2*float(x)/(image_size_.x - 1)) - 1;
-      float j = (2*float(y)/(image_size_.y - 1)) - 1;
-
-      glm::vec2 coord = glm::vec2(i, j);
-      Ray ray = camera_.GenerateRay(coord);
-      HitRecord record;
-
-      glm::vec3 colour = TraceRay(ray, max_bounces_, record);
+      glm::vec3 colour = TracePixel(glm::vec2(x, y));
       // std::cout << x << std::endl;
       image.SetPixel(x, y, colour);
     }
@@ -42,6 +69,33 @@ void Tracer::Render(const Scene& scene, const std::string& output_file) {
     image.SavePNG(output_file);
 }
 
+void Tracer::Prepare(const Scene& scene) {
+  scene_ptr_ = &scene;
+
+  auto& root = scene_ptr_->GetRootNode();
+  tracing_components_ = root.GetComponentPtrsInChildren<TracingComponent>();
+  light_components_ = root.GetComponentPtrsInChildren<LightComponent>();
+  ray_stats_ = RayStats();
+  if (light_samples_ > 0)
+    light_tree_.Build(light_components_);
+}
+
+glm::vec3 Tracer::TracePixel(const glm::vec2& pixel) {
+  float i = (2*pixel.x/(image_size_.x - 1)) - 1;
+  float j = (2*pixel.y/(image_size_.y - 1)) - 1;
+
+  glm::vec2 coord = glm::vec2(i, j);
+  Ray ray = camera_.GenerateRay(coord);
+  HitRecord record;
+  ray_stats_.primary++;
+
+  return TraceRay(ray, max_bounces_, record);
+}
+
+void Tracer::SetCamera(const CameraSpec& camera_spec) {
+  camera_ = PerspectiveCamera(camera_spec);
+}
+
 
 glm::vec3 Tracer::TraceRay(const Ray& ray,
                            size_t bounces,
@@ -61,6 +115,8 @@ glm::vec3 Tracer::TraceRay(const Ray& ray,
       glm::vec3 new_norm = glm::vec3(mod_norm.x, mod_norm.y, mod_norm.z);
       glm::vec3 n_norm = glm::normalize(new_norm);
       record.normal = n_norm;
+      glm::vec4 mod_geometric_norm = glm::transpose(glm::inverse(transform)) * glm::vec4(record.geometric_normal, 0.f);
+      record.geometric_normal = glm::normalize(glm::vec3(mod_geometric_norm));
     }
   }
 
@@ -70,72 +126,45 @@ glm::vec3 Tracer::TraceRay(const Ray& ray,
   else {
       glm::vec3 diffuse_ = tracing_components_[closest_index]->GetNodePtr()->GetComponentPtr<MaterialComponent>()->GetMaterial().GetDiffuseColor();
       glm::vec3 specular_ = tracing_components_[closest_index]->GetNodePtr()->GetComponentPtr<MaterialComponent>()->GetMaterial().GetSpecularColor();
-      float shininess = tracing_components_[closest_index]->GetNodePtr()->GetComponentPtr<MaterialComponent>()->GetMaterial().GetShininess();
 
       glm::vec3 colour = glm::vec3(0, 0, 0);
 
       glm::vec3 hit_position = ray.At(record.time);
-      glm::vec3 direction_to_light;
-      glm::vec3 illumination_intensity;
-      float distance_to_light;
+      glm::vec3 hit_error = HitPointError(ray, record.time);
+      const Material& material = tracing_components_[closest_index]->GetNodePtr()->GetComponentPtr<MaterialComponent>()->GetMaterial();
 
       glm::vec3 reflected_ray_eye = ray.GetDirection() - (2*glm::dot(ray.GetDirection(), record.normal) * record.normal);
 
       for (int i = 0; i < light_components_.size(); i ++) {
-        glm::vec3 ambient_component = glm::vec3(0, 0, 0);
-        glm::vec3 diffuse_component = glm::vec3(0, 0, 0);
-        glm::vec3 specular_component = glm::vec3(0, 0, 0);
-
         if (light_components_[i]->GetLightPtr()->GetType() == LightType::Ambient) {
           glm::vec3 ambient_light = static_cast<AmbientLight*>(light_components_[i]->GetLightPtr())->GetAmbientColor();
-          ambient_component = ambient_light*diffuse_;
+          colour += ambient_light*diffuse_;
+        }
+        else if (light_samples_ > 0 && light_components_[i]->GetLightPtr()->GetType() == LightType::Point) {
+          continue; /* point lights are sampled from the light tree below */
+        }
+        else {
+          colour += ShadeLight(*light_components_[i], hit_position, hit_error, record, reflected_ray_eye, material);
         }
+      }
 
-        else { 
-          Illuminator::GetIllumination(*light_components_[i], hit_position, direction_to_light, illumination_intensity, distance_to_light);
-
-          if (glm::dot(direction_to_light, record.normal) > 0) {
-            diffuse_component = glm::dot(direction_to_light, record.normal)*illumination_intensity*diffuse_;
-          }
-
-          if (glm::dot(direction_to_light, reflected_ray_eye) > 0) {
-            auto value = pow(glm::dot(direction_to_light, reflected_ray_eye), shininess);
-            specular_component = value*illumination_intensity*specular_;
-          }
-          else {
-            if (shininess == 0) {
-              specular_component = illumination_intensity*specular_;
-            }
-          }
-
-          if (Tracer::shadows_enabled_) {
-            glm::vec3 surface_point = hit_position + 0.001f*direction_to_light;
-            Ray shadow_ray = Ray(surface_point, direction_to_light);
-            HitRecord shadow_record;
-
-            for (int i = 0; i < tracing_components_.size(); i++) {
-              glm::mat4 transform = tracing_components_[i]->GetNodePtr()->GetTransform().GetLocalToWorldMatrix();
-              Ray shadow_ray_c = shadow_ray;
-              shadow_ray_c.ApplyTransform(glm::inverse(transform));
-              bool intersect_ = tracing_components_[i]->GetHittable().Intersect(shadow_ray_c, camera_.GetTMin(), shadow_record);
-
-              if (intersect_) {
-                if (shadow_record.time < distance_to_light) {
-                  diffuse_component = glm::vec3(0, 0, 0);
-                  specular_component = glm::vec3(0, 0, 0);
-                }
-              }
-            }
-          }
+      if (light_samples_ > 0 && !light_tree_.IsEmpty()) {
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        /* a zero lobe direction keeps every light: specular reaches everywhere at shininess 0 */
+        glm::vec3 lobe = material.GetShininess() == 0 ? glm::vec3(0, 0, 0) : reflected_ray_eye;
+        for (size_t s = 0; s < light_samples_; s++) {
+          float pdf;
+          const LightComponent* light = light_tree_.Sample(hit_position, record.normal, lobe, uniform(rng_), pdf);
+          glm::vec3 contribution = ShadeLight(*light, hit_position, hit_error, record, reflected_ray_eye, material);
+          colour += contribution / (pdf * light_samples_); /* unbiased: the tree only skips lights ShadeLight gives nothing */
         }
-        
-        colour += ambient_component + diffuse_component + specular_component;
       }
 
       if (bounces > 0) {
-        glm::vec3 intersection = hit_position + 0.001f*reflected_ray_eye;
+        glm::vec3 intersection = OffsetRayOrigin(hit_position, hit_error, record.geometric_normal, reflected_ray_eye);
         Ray perfect = Ray(intersection, reflected_ray_eye);
         HitRecord new_record;
+        ray_stats_.reflection++;
         colour += specular_*TraceRay(perfect, bounces - 1, new_record);
       }
 
@@ -144,6 +173,64 @@ glm::vec3 Tracer::TraceRay(const Ray& ray,
 }
 
 
+glm::vec3 Tracer::ShadeLight(const LightComponent& light,
+                             const glm::vec3& hit_position,
+                             const glm::vec3& hit_error,
+                             const HitRecord& record,
+                             const glm::vec3& reflected_ray_eye,
+                             const Material& material) const {
+  const glm::vec3& normal = record.normal;
+  glm::vec3 diffuse_ = material.GetDiffuseColor();
+  glm::vec3 specular_ = material.GetSpecularColor();
+  float shininess = material.GetShininess();
+
+  glm::vec3 direction_to_light;
+  glm::vec3 illumination_intensity;
+  float distance_to_light;
+  glm::vec3 diffuse_component = glm::vec3(0, 0, 0);
+  glm::vec3 specular_component = glm::vec3(0, 0, 0);
+
+  Illuminator::GetIllumination(light, hit_position, direction_to_light, illumination_intensity, distance_to_light);
+
+  if (glm::dot(direction_to_light, normal) > 0) {
+    diffuse_component = glm::dot(direction_to_light, normal)*illumination_intensity*diffuse_;
+  }
+
+  if (glm::dot(direction_to_light, reflected_ray_eye) > 0) {
+    float value = pow(glm::dot(direction_to_light, reflected_ray_eye), shininess);
+    specular_component = value*illumination_intensity*specular_;
+  }
+  else {
+    if (shininess == 0) {
+      specular_component = illumination_intensity*specular_;
+    }
+  }
+
+  if (Tracer::shadows_enabled_) {
+    glm::vec3 surface_point = OffsetRayOrigin(hit_position, hit_error, record.geometric_normal, direction_to_light);
+    Ray shadow_ray = Ray(surface_point, direction_to_light);
+    HitRecord shadow_record;
+    ray_stats_.shadow++;
+
+    for (int i = 0; i < tracing_components_.size(); i++) {
+      glm::mat4 transform = tracing_components_[i]->GetNodePtr()->GetTransform().GetLocalToWorldMatrix();
+      Ray shadow_ray_c = shadow_ray;
+      shadow_ray_c.ApplyTransform(glm::inverse(transform));
+      bool intersect_ = tracing_components_[i]->GetHittable().Intersect(shadow_ray_c, camera_.GetTMin(), shadow_record);
+
+      if (intersect_) {
+        if (shadow_record.time < distance_to_light) {
+          diffuse_component = glm::vec3(0, 0, 0);
+          specular_component = glm::vec3(0, 0, 0);
+        }
+      }
+    }
+  }
+
+  return diffuse_component + specular_component;
+}
+
+
 glm::vec3 Tracer::GetBackgroundColor(const glm::vec3& direction) const {
   if (cube_map_ != nullptr) {
     return cube_map_->GetTexel(direction);
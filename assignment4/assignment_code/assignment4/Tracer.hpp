@@ -1,6 +1,8 @@
 #ifndef TRACER_H_
 #define TRACER_H_
 
+#include <random>
+
 #include "gloo/Scene.hpp"
 #include "gloo/Material.hpp"
 #include "gloo/lights/LightBase.hpp"
@@ -11,6 +13,7 @@
 #include "TracingComponent.hpp"
 #include "CubeMap.hpp"
 #include "PerspectiveCamera.hpp"
+#include "LightTree.hpp"
 
 namespace GLOO {
 class Tracer {
@@ -20,20 +23,52 @@ class Tracer {
          size_t max_bounces,
          const glm::vec3& background_color,
          const CubeMap* cube_map,
-         bool shadows_enabled)
+         bool shadows_enabled,
+         size_t light_samples = 0)
       : camera_(camera_spec),
         image_size_(image_size),
         max_bounces_(max_bounces),
         background_color_(background_color),
         cube_map_(cube_map),
         shadows_enabled_(shadows_enabled),
+        light_samples_(light_samples),
         scene_ptr_(nullptr) {
   }
   void Render(const Scene& scene, const std::string& output_file);
 
+  // Collects the components of scene to trace against. Render() calls this
+  // itself; callers tracing pixels one at a time must call it first.
+  void Prepare(const Scene& scene);
+  // Color seen through a pixel position; integer coordinates are pixel
+  // centers, fractional ones may be used to jitter samples.
+  glm::vec3 TracePixel(const glm::vec2& pixel);
+  void SetCamera(const CameraSpec& camera_spec);
+  const glm::ivec2& GetImageSize() const {
+    return image_size_;
+  }
+
+  // Number of rays of each kind traced by the last call to Render().
+  struct RayStats {
+    size_t primary = 0;
+    size_t shadow = 0;
+    size_t reflection = 0;
+  };
+  const RayStats& GetRayStats() const {
+    return ray_stats_;
+  }
+
  private:
   glm::vec3 TraceRay(const Ray& ray, size_t bounces, HitRecord& record) const;
 
+  // Diffuse and specular contribution of a single non-ambient light,
+  // including its shadow ray.
+  glm::vec3 ShadeLight(const LightComponent& light,
+                       const glm::vec3& hit_position,
+                       const glm::vec3& hit_error,
+                       const HitRecord& record,
+                       const glm::vec3& reflected_ray_eye,
+                       const Material& material) const;
+
   glm::vec3 GetBackgroundColor(const glm::vec3& direction) const;
 
   PerspectiveCamera camera_;
@@ -45,8 +80,14 @@ class Tracer {
   glm::vec3 background_color_;
   const CubeMap* cube_map_;
   bool shadows_enabled_;
+  // When non-zero, point lights are not looped over; instead this many
+  // are sampled from light_tree_ per hit.
+  size_t light_samples_;
+  LightTree light_tree_;
+  mutable std::mt19937 rng_;
 
   const Scene* scene_ptr_;
+  mutable RayStats ray_stats_;
 };
 }  // namespace GLOO
 
@@ -0,0 +1,72 @@
+#include "TracerPreviewApp.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "gloo/external.hpp"
+#include "gloo/cameras/ArcBallCameraNode.hpp"
+#include "gloo/components/LightComponent.hpp"
+#include "gloo/lights/AmbientLight.hpp"
+
+namespace GLOO {
+TracerPreviewApp::TracerPreviewApp(const std::string& app_name,
+                                   glm::ivec2 window_size,
+                                   Tracer& tracer,
+                                   const Scene& tracing_scene,
+                                   const CameraSpec& camera_spec,
+                                   size_t max_passes)
+    : Application(app_name, window_size),
+      tracer_(tracer),
+      tracing_scene_(tracing_scene),
+      camera_spec_(camera_spec),
+      max_passes_(max_passes),
+      preview_node_ptr_(nullptr) {
+}
+
+void TracerPreviewApp::SetupScene() {
+  SceneNode& root = scene_->GetRootNode();
+
+  // Orbit around the point of the view axis closest to the world origin,
+  // which is where the scene files aim their cameras.
+  glm::vec3 direction = glm::normalize(camera_spec_.direction);
+  float distance = glm::dot(-camera_spec_.center, direction);
+  if (distance <= 0.0f) {
+    distance = 1.0f;
+  }
+  glm::vec3 pivot = camera_spec_.center + distance * direction;
+
+  // ArcBallCameraNode views from (0, 0, distance) after rotating and then
+  // translating the world, so this reproduces lookAt(center, pivot, up).
+  glm::mat4 look_at = glm::lookAt(camera_spec_.center, pivot, camera_spec_.up);
+  glm::ivec2 window_size = GetWindowSize();
+  float aspect_ratio = float(window_size.x) / float(window_size.y);
+  auto camera_node =
+      make_unique<ArcBallCameraNode>(camera_spec_.fov, aspect_ratio, distance);
+  camera_node->GetTransform().SetRotation(glm::quat_cast(glm::mat3(look_at)));
+  camera_node->GetTransform().SetPosition(-pivot);
+  camera_node->Calibrate();
+  auto camera_ptr = camera_node->GetComponentPtr<CameraComponent>();
+  scene_->ActivateCamera(camera_ptr);
+  root.AddChild(std::move(camera_node));
+
+  // The renderer draws one pass per light; a white ambient light shows the
+  // textured quad exactly once.
+  auto ambient_light = std::make_shared<AmbientLight>();
+  ambient_light->SetAmbientColor(glm::vec3(1.0f));
+  root.CreateComponent<LightComponent>(ambient_light);
+
+  auto preview_node = make_unique<TracerPreviewNode>(
+      tracer_, tracing_scene_, *camera_ptr, camera_spec_.fov, max_passes_);
+  preview_node_ptr_ = preview_node.get();
+  root.AddChild(std::move(preview_node));
+}
+
+void TracerPreviewApp::DrawGUI() {
+  ImGui::Begin("Progressive Preview");
+  ImGui::Text("Pass %zu / %zu", preview_node_ptr_->GetCompletedPasses(),
+              preview_node_ptr_->GetMaxPasses());
+  ImGui::Text("Tile %zu / %zu", preview_node_ptr_->GetCompletedTiles(),
+              preview_node_ptr_->GetTileCount());
+  ImGui::End();
+}
+}  // namespace GLOO
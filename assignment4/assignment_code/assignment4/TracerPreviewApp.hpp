@@ -0,0 +1,40 @@
+#ifndef TRACER_PREVIEW_APP_H_
+#define TRACER_PREVIEW_APP_H_
+
+#include "gloo/Application.hpp"
+
+#include "Tracer.hpp"
+#include "CameraSpec.hpp"
+#include "TracerPreviewNode.hpp"
+
+namespace GLOO {
+// Interactive front end for the ray tracer. The arc-ball camera starts at
+// the scene file's camera and orbits a point in front of it; the traced
+// image refines in the background and restarts whenever the view changes.
+class TracerPreviewApp : public Application {
+ public:
+  TracerPreviewApp(const std::string& app_name,
+                   glm::ivec2 window_size,
+                   Tracer& tracer,
+                   const Scene& tracing_scene,
+                   const CameraSpec& camera_spec,
+                   size_t max_passes);
+  void SetupScene() override;
+
+  const Image& GetImage() const {
+    return preview_node_ptr_->GetImage();
+  }
+
+ protected:
+  void DrawGUI() override;
+
+ private:
+  Tracer& tracer_;
+  const Scene& tracing_scene_;
+  CameraSpec camera_spec_;
+  size_t max_passes_;
+  TracerPreviewNode* preview_node_ptr_;
+};
+}  // namespace GLOO
+
+#endif
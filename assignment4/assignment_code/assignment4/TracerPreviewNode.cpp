@@ -0,0 +1,122 @@
+#include "TracerPreviewNode.hpp"
+
+#include <chrono>
+#include <algorithm>
+
+#include "gloo/components/RenderingComponent.hpp"
+#include "gloo/components/ShadingComponent.hpp"
+#include "gloo/debug/PrimitiveFactory.hpp"
+
+namespace {
+const int kTileSize = 16;
+// Tracing time spent per frame, so the window stays responsive while
+// dragging the camera.
+const std::chrono::duration<double> kFrameBudget(1.0 / 30.0);
+}  // namespace
+
+namespace GLOO {
+TracerPreviewNode::TracerPreviewNode(Tracer& tracer,
+                                     const Scene& tracing_scene,
+                                     const CameraComponent& camera,
+                                     float fov,
+                                     size_t max_passes)
+    : tracer_(tracer),
+      camera_(camera),
+      fov_(fov),
+      max_passes_(max_passes),
+      image_size_(tracer.GetImageSize()),
+      tiles_((image_size_ + kTileSize - 1) / kTileSize),
+      last_view_matrix_(0.0f),
+      pass_(0),
+      next_tile_(0),
+      accumulation_(image_size_.x * image_size_.y),
+      image_(image_size_.x, image_size_.y) {
+  tracer_.Prepare(tracing_scene);
+
+  texture_ = make_unique<Texture>(
+      TextureConfig{{GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE},
+                    {GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE}});
+  texture_->UpdateImage(image_);
+
+  // Image::ToByteData emits rows top-down, so the texture is upside down
+  // relative to the quad's default texture coordinates.
+  std::shared_ptr<VertexObject> quad = PrimitiveFactory::CreateQuad();
+  auto tex_coords = make_unique<TexCoordArray>();
+  tex_coords->emplace_back(0.0f, 1.0f);
+  tex_coords->emplace_back(1.0f, 1.0f);
+  tex_coords->emplace_back(1.0f, 0.0f);
+  tex_coords->emplace_back(0.0f, 0.0f);
+  quad->UpdateTexCoord(std::move(tex_coords));
+  CreateComponent<RenderingComponent>(quad);
+
+  shader_ = std::make_shared<PlainTextureShader>();
+  shader_->AttachTexture(texture_.get());
+  CreateComponent<ShadingComponent>(shader_);
+}
+
+void TracerPreviewNode::Update(double delta_time) {
+  glm::mat4 view_matrix = camera_.GetViewMatrix();
+  if (view_matrix != last_view_matrix_) {
+    Restart(view_matrix);
+  }
+  if (pass_ >= max_passes_) {
+    return;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start_time = Clock::now();
+  do {
+    TraceTile(next_tile_);
+    next_tile_++;
+    if (next_tile_ == GetTileCount()) {
+      next_tile_ = 0;
+      pass_++;
+    }
+  } while (pass_ < max_passes_ && Clock::now() - start_time < kFrameBudget);
+
+  texture_->BindToUnit(0);
+  texture_->UpdateImage(image_);
+}
+
+void TracerPreviewNode::Restart(const glm::mat4& view_matrix) {
+  last_view_matrix_ = view_matrix;
+
+  // The tracer's camera sits where the view matrix puts the eye, looking
+  // down its -z axis.
+  glm::mat4 camera_to_world = glm::inverse(view_matrix);
+  CameraSpec spec;
+  spec.center = glm::vec3(camera_to_world[3]);
+  spec.direction = -glm::vec3(camera_to_world[2]);
+  spec.up = glm::vec3(camera_to_world[1]);
+  spec.fov = fov_;
+  tracer_.SetCamera(spec);
+
+  // Keep showing the stale image until the new pass overwrites it.
+  std::fill(accumulation_.begin(), accumulation_.end(), glm::vec3(0.0f));
+  pass_ = 0;
+  next_tile_ = 0;
+  rng_.seed();
+}
+
+void TracerPreviewNode::TraceTile(size_t tile) {
+  glm::ivec2 begin(int(tile % tiles_.x) * kTileSize,
+                   int(tile / tiles_.x) * kTileSize);
+  glm::ivec2 end = glm::min(begin + kTileSize, image_size_);
+
+  // The first pass samples pixel centers like the offline renderer; later
+  // passes jitter within the pixel to anti-alias.
+  std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+  float weight = 1.0f / float(pass_ + 1);
+  for (int y = begin.y; y < end.y; y++) {
+    for (int x = begin.x; x < end.x; x++) {
+      glm::vec2 pixel(x, y);
+      if (pass_ > 0) {
+        pixel += glm::vec2(jitter(rng_), jitter(rng_));
+      }
+      glm::vec3& sum = accumulation_[y * image_size_.x + x];
+      sum += tracer_.TracePixel(pixel);
+      image_.SetPixel(x, y, sum * weight);
+    }
+  }
+}
+}  // namespace GLOO
@@ -0,0 +1,69 @@
+#ifndef TRACER_PREVIEW_NODE_H_
+#define TRACER_PREVIEW_NODE_H_
+
+#include <random>
+
+#include "gloo/SceneNode.hpp"
+#include "gloo/Image.hpp"
+#include "gloo/gl_wrapper/Texture.hpp"
+#include "gloo/shaders/PlainTextureShader.hpp"
+#include "gloo/components/CameraComponent.hpp"
+
+#include "Tracer.hpp"
+
+namespace GLOO {
+// Draws the ray-traced image of a scene as a full-window textured quad and
+// refines it progressively: every Update traces tiles for a fixed time
+// budget and uploads the result. Each pass adds one jittered sample per
+// pixel to a running average, and everything restarts when the camera moves.
+class TracerPreviewNode : public SceneNode {
+ public:
+  TracerPreviewNode(Tracer& tracer,
+                    const Scene& tracing_scene,
+                    const CameraComponent& camera,
+                    float fov,
+                    size_t max_passes);
+  void Update(double delta_time) override;
+
+  size_t GetCompletedPasses() const {
+    return pass_;
+  }
+  size_t GetMaxPasses() const {
+    return max_passes_;
+  }
+  size_t GetCompletedTiles() const {
+    return next_tile_;
+  }
+  size_t GetTileCount() const {
+    return tiles_.x * tiles_.y;
+  }
+  // Average of all completed samples; tiles of the pass in flight show their
+  // newest average too.
+  const Image& GetImage() const {
+    return image_;
+  }
+
+ private:
+  void Restart(const glm::mat4& view_matrix);
+  void TraceTile(size_t tile);
+
+  Tracer& tracer_;
+  const CameraComponent& camera_;
+  float fov_;
+  size_t max_passes_;
+
+  glm::ivec2 image_size_;
+  glm::ivec2 tiles_;
+  glm::mat4 last_view_matrix_;
+  size_t pass_;
+  size_t next_tile_;
+  std::vector<glm::vec3> accumulation_;
+  Image image_;
+  std::mt19937 rng_;
+
+  std::unique_ptr<Texture> texture_;
+  std::shared_ptr<PlainTextureShader> shader_;
+};
+}  // namespace GLOO
+
+#endif
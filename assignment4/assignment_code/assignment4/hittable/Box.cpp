@@ -0,0 +1,60 @@
+#include "Box.hpp"
+
+#include <limits>
+#include <utility>
+
+namespace GLOO {
+bool Box::Intersect(const Ray& ray, float t_min, HitRecord& record) const {
+  const glm::vec3& origin = ray.GetOrigin();
+  const glm::vec3& direction = ray.GetDirection();
+
+  // Slab test: clip the ray against the three pairs of parallel planes,
+  // remembering which axis produced the entry and exit distances.
+  float t_near = -std::numeric_limits<float>::max();
+  float t_far = std::numeric_limits<float>::max();
+  int near_axis = -1;
+  int far_axis = -1;
+  for (int dim = 0; dim < 3; dim++) {
+    float inv_dir = 1.0f / direction[dim];
+    float t0 = (mn_[dim] - origin[dim]) * inv_dir;
+    float t1 = (mx_[dim] - origin[dim]) * inv_dir;
+    if (t0 > t1) {
+      std::swap(t0, t1);
+    }
+    if (t0 > t_near) {
+      t_near = t0;
+      near_axis = dim;
+    }
+    if (t1 < t_far) {
+      t_far = t1;
+      far_axis = dim;
+    }
+  }
+
+  if (t_near > t_far || near_axis < 0 || far_axis < 0) {
+    return false;
+  }
+
+  float t;
+  glm::vec3 normal(0.0f);
+  if (t_near >= t_min) {
+    // Entering the box; the face normal points against the ray.
+    t = t_near;
+    normal[near_axis] = direction[near_axis] < 0 ? 1.0f : -1.0f;
+  } else if (t_far >= t_min) {
+    // Origin is inside the box; the exit face normal points along the ray.
+    t = t_far;
+    normal[far_axis] = direction[far_axis] < 0 ? -1.0f : 1.0f;
+  } else {
+    return false;
+  }
+
+  if (t < record.time) {
+    record.time = t;
+    record.normal = normal;
+    record.geometric_normal = normal;
+    return true;
+  }
+  return false;
+}
+}  // namespace GLOO
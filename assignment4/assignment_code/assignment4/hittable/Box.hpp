@@ -0,0 +1,20 @@
+#ifndef BOX_H_
+#define BOX_H_
+
+#include "HittableBase.hpp"
+
+namespace GLOO {
+class Box : public HittableBase {
+ public:
+  // An axis-aligned box spanning [mn, mx] in its local coordinate.
+  Box(const glm::vec3& mn, const glm::vec3& mx) : mn_(mn), mx_(mx) {
+  }
+  bool Intersect(const Ray& ray, float t_min, HitRecord& record) const override;
+
+ private:
+  glm::vec3 mn_;
+  glm::vec3 mx_;
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,62 @@
+#include "Cylinder.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace GLOO {
+bool Cylinder::Intersect(const Ray& ray,
+                         float t_min,
+                         HitRecord& record) const {
+  const glm::vec3& origin = ray.GetOrigin();
+  const glm::vec3& direction = ray.GetDirection();
+  float half_height = 0.5f * height_;
+
+  float t = std::numeric_limits<float>::max();
+  glm::vec3 normal;
+
+  // Side wall: x^2 + z^2 = r^2, restricted to the height range.
+  float a = direction.x * direction.x + direction.z * direction.z;
+  if (a > 0) {
+    float b = 2 * (direction.x * origin.x + direction.z * origin.z);
+    float c = origin.x * origin.x + origin.z * origin.z - radius_ * radius_;
+    float d = b * b - 4 * a * c;
+    if (d >= 0) {
+      d = sqrt(d);
+      float roots[2] = {(-b - d) / (2 * a), (-b + d) / (2 * a)};
+      for (float root : roots) {
+        if (root < t_min || root >= t)
+          continue;
+        glm::vec3 p = ray.At(root);
+        if (std::abs(p.y) <= half_height) {
+          t = root;
+          normal = glm::vec3(p.x, 0.0f, p.z) / radius_;
+          break;
+        }
+      }
+    }
+  }
+
+  // End caps: the planes y = +-h/2, restricted to the disk.
+  if (direction.y != 0) {
+    float caps[2] = {-half_height, half_height};
+    for (float cap_y : caps) {
+      float root = (cap_y - origin.y) / direction.y;
+      if (root < t_min || root >= t)
+        continue;
+      glm::vec3 p = ray.At(root);
+      if (p.x * p.x + p.z * p.z <= radius_ * radius_) {
+        t = root;
+        normal = glm::vec3(0.0f, cap_y > 0 ? 1.0f : -1.0f, 0.0f);
+      }
+    }
+  }
+
+  if (t < record.time) {
+    record.time = t;
+    record.normal = normal;
+    record.geometric_normal = normal;
+    return true;
+  }
+  return false;
+}
+}  // namespace GLOO
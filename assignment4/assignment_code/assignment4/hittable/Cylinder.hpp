@@ -0,0 +1,21 @@
+#ifndef CYLINDER_H_
+#define CYLINDER_H_
+
+#include "HittableBase.hpp"
+
+namespace GLOO {
+class Cylinder : public HittableBase {
+ public:
+  // A capped cylinder is always centered at origin in its local coordinate,
+  // with its axis along y and spanning [-height / 2, height / 2].
+  Cylinder(float radius, float height) : radius_(radius), height_(height) {
+  }
+  bool Intersect(const Ray& ray, float t_min, HitRecord& record) const override;
+
+ private:
+  float radius_;
+  float height_;
+};
+}  // namespace GLOO
+
+#endif
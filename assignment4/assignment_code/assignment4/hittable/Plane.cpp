@@ -12,6 +12,7 @@ bool Plane::Intersect(const Ray& ray, float t_min, HitRecord& record) const {
   if (t > t_min && t <= record.time) {
     record.time = t;
     record.normal = normal_;
+    record.geometric_normal = normal_;
     return true;
   }
   return false;
@@ -0,0 +1,36 @@
+#include "Quad.hpp"
+
+namespace GLOO {
+Quad::Quad(const glm::vec3& corner,
+           const glm::vec3& edge0,
+           const glm::vec3& edge1)
+    : corner_(corner), edge0_(edge0), edge1_(edge1) {
+  glm::vec3 n = glm::cross(edge0, edge1);
+  normal_ = glm::normalize(n);
+  w_ = n / glm::dot(n, n);
+}
+
+bool Quad::Intersect(const Ray& ray, float t_min, HitRecord& record) const {
+  float denom = glm::dot(normal_, ray.GetDirection());
+  if (denom == 0) {
+    return false;
+  }
+
+  float t = glm::dot(normal_, corner_ - ray.GetOrigin()) / denom;
+  if (t < t_min || t >= record.time) {
+    return false;
+  }
+
+  glm::vec3 p = ray.At(t) - corner_;
+  float alpha = glm::dot(w_, glm::cross(p, edge1_));
+  float beta = glm::dot(w_, glm::cross(edge0_, p));
+  if (alpha < 0 || alpha > 1 || beta < 0 || beta > 1) {
+    return false;
+  }
+
+  record.time = t;
+  record.normal = normal_;
+  record.geometric_normal = normal_;
+  return true;
+}
+}  // namespace GLOO
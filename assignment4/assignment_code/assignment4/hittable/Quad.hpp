@@ -0,0 +1,23 @@
+#ifndef QUAD_H_
+#define QUAD_H_
+
+#include "HittableBase.hpp"
+
+namespace GLOO {
+class Quad : public HittableBase {
+ public:
+  // A parallelogram spanning corner + a * edge0 + b * edge1, a, b in [0, 1].
+  Quad(const glm::vec3& corner, const glm::vec3& edge0, const glm::vec3& edge1);
+  bool Intersect(const Ray& ray, float t_min, HitRecord& record) const override;
+
+ private:
+  glm::vec3 corner_;
+  glm::vec3 edge0_;
+  glm::vec3 edge1_;
+  glm::vec3 normal_;
+  // Scaled normal used to recover the edge coordinates of a hit point.
+  glm::vec3 w_;
+};
+}  // namespace GLOO
+
+#endif
@@ -1,6 +1,7 @@
 #include "Sphere.hpp"
 
 #include <cmath>
+#include <utility>
 
 #include <glm/gtx/norm.hpp>
 
@@ -17,8 +18,15 @@ bool Sphere::Intersect(const Ray& ray, float t_min, HitRecord& record) const {
   }
   d = sqrt(d);
 
-  float t_plus = (-b + d) / (2 * a);
-  float t_minus = (-b - d) / (2 * a);
+  // Avoid the cancellation in -b +- d when |b| is close to d.
+  float q = b < 0 ? -0.5f * (b - d) : -0.5f * (b + d);
+  float t_plus = q / a;
+  // q is zero only for a grazing ray from the surface (b = d = 0), where
+  // c / q is 0 / 0 and the double root is t_plus.
+  float t_minus = q != 0 ? c / q : t_plus;
+  if (t_minus > t_plus) {
+    std::swap(t_minus, t_plus);
+  }
 
   float t;
   if (t_minus < t_min) {
@@ -34,6 +42,7 @@ bool Sphere::Intersect(const Ray& ray, float t_min, HitRecord& record) const {
   if (t < record.time) {
     record.time = t;
     record.normal = glm::normalize(ray.At(t));
+    record.geometric_normal = record.normal;
     return true;
   }
 
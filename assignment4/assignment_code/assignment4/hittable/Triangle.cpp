@@ -1,5 +1,6 @@
 #include "Triangle.hpp"
 
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
 
@@ -30,33 +31,62 @@ Triangle::Triangle(const std::vector<glm::vec3>& positions,
 }
 
 bool Triangle::Intersect(const Ray& ray, float t_min, HitRecord& record) const {
-  float A_11 = GetPosition(0).x - GetPosition(1).x;
-  float A_12 = GetPosition(0).x - GetPosition(2).x;
-  float A_13 = ray.GetDirection().x;
-  float A_21 = GetPosition(0).y - GetPosition(1).y;
-  float A_22 = GetPosition(0).y - GetPosition(2).y;
-  float A_23 = ray.GetDirection().y;
-  float A_31 = GetPosition(0).z - GetPosition(1).z;
-  float A_32 = GetPosition(0).z - GetPosition(2).z;
-  float A_33 = ray.GetDirection().z;
+  // Watertight test (Woop et al. 2013): move the ray origin to zero, permute
+  // and shear so the ray runs along +z, then evaluate the 2D edge functions.
+  // A ray through a shared edge or vertex hits at least one of the adjacent
+  // triangles, so meshes do not leak at their seams.
+  const glm::vec3& dir = ray.GetDirection();
+  int kz = 0;
+  if (std::abs(dir.y) > std::abs(dir[kz]))
+    kz = 1;
+  if (std::abs(dir.z) > std::abs(dir[kz]))
+    kz = 2;
+  int kx = (kz + 1) % 3;
+  int ky = (kx + 1) % 3;
 
-  glm::mat3 A(A_11, A_12, A_13,
-              A_21, A_22, A_23,
-              A_31, A_32, A_33);
+  float shear_x = -dir[kx] / dir[kz];
+  float shear_y = -dir[ky] / dir[kz];
+  float shear_z = 1.0f / dir[kz];
 
-  glm::vec3 b = GetPosition(0) - ray.GetOrigin();	
-  glm::vec3 x = b*glm::inverse(A);
-  float beta = x.x;
-  float gamma = x.y;
-  float t = x.z;
+  glm::vec3 p[3];
+  for (int i = 0; i < 3; i++) {
+    glm::vec3 v = GetPosition(i) - ray.GetOrigin();
+    p[i] = glm::vec3(v[kx] + shear_x * v[kz], v[ky] + shear_y * v[kz],
+                     v[kz] * shear_z);
+  }
+
+  float e0 = p[1].x * p[2].y - p[1].y * p[2].x;
+  float e1 = p[2].x * p[0].y - p[2].y * p[0].x;
+  float e2 = p[0].x * p[1].y - p[0].y * p[1].x;
+  // Fall back to double precision when a ray lands exactly on an edge.
+  if (e0 == 0.0f || e1 == 0.0f || e2 == 0.0f) {
+    e0 = float((double)p[1].x * p[2].y - (double)p[1].y * p[2].x);
+    e1 = float((double)p[2].x * p[0].y - (double)p[2].y * p[0].x);
+    e2 = float((double)p[0].x * p[1].y - (double)p[0].y * p[1].x);
+  }
 
-  if (beta + gamma > 1 || beta < 0 || gamma < 0) {
+  if ((e0 < 0 || e1 < 0 || e2 < 0) && (e0 > 0 || e1 > 0 || e2 > 0)) {
     return false;
-  }  
+  }
+  float det = e0 + e1 + e2;
+  if (det == 0) {
+    return false;
+  }
 
+  float t = (e0 * p[0].z + e1 * p[1].z + e2 * p[2].z) / det;
   if (t >= t_min && t < record.time) {
+    float beta = e1 / det;
+    float gamma = e2 / det;
+    glm::vec3 geometric_normal = glm::normalize(
+        glm::cross(GetPosition(1) - GetPosition(0), GetPosition(2) - GetPosition(0)));
+
     record.time = t;
     record.normal = glm::normalize((1.0f - beta - gamma)*GetNormal(0) + beta*GetNormal(1) + gamma*GetNormal(2));
+    // Keep both normals on the same side of the surface.
+    if (glm::dot(geometric_normal, record.normal) < 0) {
+      geometric_normal = -geometric_normal;
+    }
+    record.geometric_normal = geometric_normal;
     return true;
   }
   return false;
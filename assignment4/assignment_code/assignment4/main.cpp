@@ -6,11 +6,46 @@
 
 #include "hittable/Sphere.hpp"
 #include "Tracer.hpp"
+#include "TracerPreviewApp.hpp"
 #include "SceneParser.hpp"
 #include "ArgParser.hpp"
 
 using namespace GLOO;
 
+namespace {
+// Runs the interactive preview until the window closes or frame_count
+// frames have been shown, then saves the accumulated image if requested.
+void RunPreview(const ArgParser& arg_parser,
+                Tracer& tracer,
+                const Scene& scene,
+                const CameraSpec& camera_spec) {
+  auto app = make_unique<TracerPreviewApp>(
+      "Assignment4", glm::ivec2(arg_parser.width, arg_parser.height), tracer,
+      scene, camera_spec, arg_parser.preview_passes);
+
+  app->SetupScene();
+
+  using Clock = std::chrono::high_resolution_clock;
+  using TimePoint =
+      std::chrono::time_point<Clock, std::chrono::duration<double>>;
+  TimePoint last_tick_time = Clock::now();
+  TimePoint start_tick_time = last_tick_time;
+  size_t frame_count = 0;
+  while (!app->IsFinished() && (arg_parser.preview_frames == 0 ||
+                                frame_count < arg_parser.preview_frames)) {
+    TimePoint current_tick_time = Clock::now();
+    double delta_time = (current_tick_time - last_tick_time).count();
+    double total_elapsed_time = (current_tick_time - start_tick_time).count();
+    app->Tick(delta_time, total_elapsed_time);
+    last_tick_time = current_tick_time;
+    frame_count++;
+  }
+
+  if (arg_parser.output_file.size())
+    app->GetImage().SavePNG(arg_parser.output_file);
+}
+}  // namespace
+
 int main(int argc, const char* argv[]) {
   ArgParser arg_parser(argc, argv);
   SceneParser scene_parser;
@@ -19,7 +54,12 @@ int main(int argc, const char* argv[]) {
   Tracer tracer(scene_parser.GetCameraSpec(),
                 glm::ivec2(arg_parser.width, arg_parser.height),
                 arg_parser.bounces, scene_parser.GetBackgroundColor(),
-                scene_parser.GetCubeMapPtr(), arg_parser.shadows);
-  tracer.Render(*scene, arg_parser.output_file);
+                scene_parser.GetCubeMapPtr(), arg_parser.shadows,
+                arg_parser.light_samples);
+  if (arg_parser.preview) {
+    RunPreview(arg_parser, tracer, *scene, scene_parser.GetCameraSpec());
+  } else {
+    tracer.Render(*scene, arg_parser.output_file);
+  }
   return 0;
 }
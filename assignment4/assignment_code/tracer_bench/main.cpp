@@ -0,0 +1,361 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "gloo/Scene.hpp"
+#include "gloo/parsers/ObjParser.hpp"
+
+#include "helpers.hpp"
+
+#include "Tracer.hpp"
+#include "SceneParser.hpp"
+#include "CubeMap.hpp"
+#include "Octree.hpp"
+#include "hittable/Mesh.hpp"
+#include "hittable/Sphere.hpp"
+#include "hittable/Triangle.hpp"
+
+using namespace GLOO;
+
+namespace {
+using Clock = std::chrono::high_resolution_clock;
+
+double SecondsSince(const Clock::time_point& start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Metric {
+  std::string name;
+  double value;
+  std::string unit;
+  // "max" if the metric must stay below the threshold, "min" if above.
+  std::string comparison;
+  double threshold;
+  bool has_threshold;
+  bool passed;
+};
+
+struct BenchOptions {
+  size_t width = 100;
+  size_t height = 100;
+  size_t bounces = 3;
+  size_t intersect_tests = 1 << 20;
+  size_t octree_builds = 5;
+  size_t light_samples = 4;
+  // The many-light scene shades every light per hit when not sampling, so it
+  // is rendered at a smaller resolution.
+  size_t many_light_size = 32;
+  std::string output_file;
+  std::string thresholds_file;
+};
+
+const char* kScenes[] = {"scene01_plane", "scene02_cube",      "scene03_sphere",
+                         "scene04_axes",  "scene05_bunny_200", "scene06_bunny_1k",
+                         "scene07_arch",  "scene09_shapes"};
+
+const char* kManyLightScene = "scene08_city_lights";
+
+const char* kModels[] = {"cube2", "bunny_200", "bunny_1k"};
+
+void PrintUsage(const char* program) {
+  printf("Usage: %s [-size <w> <h>] [-bounces <n>] [-tests <n>]\n", program);
+  printf("          [-builds <n>] [-light_samples <n>] [-light_size <n>]\n");
+  printf("          [-output <file.json>]\n");
+  printf("          [-thresholds <file>]\n");
+}
+
+BenchOptions ParseOptions(int argc, const char* argv[]) {
+  BenchOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-size") && i + 2 < argc) {
+      options.width = atoi(argv[++i]);
+      options.height = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-bounces") && i + 1 < argc) {
+      options.bounces = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-tests") && i + 1 < argc) {
+      options.intersect_tests = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-builds") && i + 1 < argc) {
+      options.octree_builds = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-light_samples") && i + 1 < argc) {
+      options.light_samples = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-light_size") && i + 1 < argc) {
+      options.many_light_size = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-output") && i + 1 < argc) {
+      options.output_file = argv[++i];
+    } else if (!strcmp(argv[i], "-thresholds") && i + 1 < argc) {
+      options.thresholds_file = argv[++i];
+    } else {
+      printf("Unknown command line argument %d: '%s'\n", i, argv[i]);
+      PrintUsage(argv[0]);
+      exit(1);
+    }
+  }
+  return options;
+}
+
+// Each non-comment line reads "<metric> <min|max> <value>".
+std::unordered_map<std::string, std::pair<std::string, double>> LoadThresholds(
+    const std::string& filename) {
+  std::unordered_map<std::string, std::pair<std::string, double>> thresholds;
+  std::ifstream ifs(filename);
+  if (!ifs) {
+    throw std::runtime_error("Unable to open thresholds file " + filename +
+                             "!");
+  }
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::istringstream ss(line);
+    std::string name, comparison;
+    double value;
+    if (!(ss >> name >> comparison >> value) ||
+        (comparison != "min" && comparison != "max")) {
+      throw std::runtime_error("Bad threshold line: " + line + "!");
+    }
+    thresholds[name] = std::make_pair(comparison, value);
+  }
+  return thresholds;
+}
+
+std::vector<Ray> RandomRaysTowardOrigin(size_t count, float distance) {
+  std::mt19937 rng(837);
+  std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+  std::vector<Ray> rays;
+  rays.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    glm::vec3 origin(uniform(rng), uniform(rng), uniform(rng));
+    if (glm::length(origin) < 1e-3f)
+      origin = glm::vec3(0.0f, 0.0f, 1.0f);
+    origin = distance * glm::normalize(origin);
+    glm::vec3 target = 0.5f * glm::vec3(uniform(rng), uniform(rng), uniform(rng));
+    rays.emplace_back(origin, glm::normalize(target - origin));
+  }
+  return rays;
+}
+
+double IntersectNanoseconds(const HittableBase& hittable,
+                            const std::vector<Ray>& rays,
+                            size_t tests,
+                            size_t& hits) {
+  hits = 0;
+  auto start = Clock::now();
+  for (size_t i = 0; i < tests; i++) {
+    HitRecord record;
+    if (hittable.Intersect(rays[i % rays.size()], 0.0f, record))
+      hits++;
+  }
+  return SecondsSince(start) * 1e9 / tests;
+}
+
+void BenchOctree(const BenchOptions& options, std::vector<Metric>& metrics) {
+  for (const char* model : kModels) {
+    std::string path =
+        GetAssetDir() + "assignment4/models/" + std::string(model) + ".obj";
+    bool success;
+    auto data = ObjParser::Parse(path, success);
+    if (!success || data.positions == nullptr || data.indices == nullptr) {
+      throw std::runtime_error("Failed at parsing " + path);
+    }
+    if (data.normals == nullptr) {
+      data.normals = CalculateNormals(*data.positions, *data.indices);
+    }
+    Mesh mesh(std::move(data.positions), std::move(data.normals),
+              std::move(data.indices));
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < options.octree_builds; i++) {
+      Octree octree;
+      octree.Build(mesh);
+    }
+    double ms = SecondsSince(start) * 1e3 / options.octree_builds;
+    metrics.push_back({"octree_build." + std::string(model) + ".ms", ms, "ms"});
+  }
+}
+
+void BenchScenes(const BenchOptions& options, std::vector<Metric>& metrics) {
+  // Each config reports the rate of its own kind of ray: rays of that kind
+  // traced per second of a render that also traces the primary rays.
+  struct RayConfig {
+    const char* name;
+    size_t bounces;
+    bool shadows;
+    size_t Tracer::RayStats::*kind;
+  };
+  const RayConfig configs[] = {
+      {"primary", 0, false, &Tracer::RayStats::primary},
+      {"shadow", 0, true, &Tracer::RayStats::shadow},
+      {"reflection", options.bounces, false, &Tracer::RayStats::reflection}};
+
+  for (const char* scene_name : kScenes) {
+    SceneParser scene_parser;
+    auto scene =
+        scene_parser.ParseScene("assignment4/" + std::string(scene_name) + ".txt");
+    if (scene == nullptr) {
+      throw std::runtime_error("Failed at parsing " + std::string(scene_name));
+    }
+
+    for (const RayConfig& config : configs) {
+      Tracer tracer(scene_parser.GetCameraSpec(),
+                    glm::ivec2(options.width, options.height), config.bounces,
+                    scene_parser.GetBackgroundColor(),
+                    scene_parser.GetCubeMapPtr(), config.shadows);
+      auto start = Clock::now();
+      tracer.Render(*scene, "");
+      double seconds = SecondsSince(start);
+
+      size_t rays = tracer.GetRayStats().*config.kind;
+      metrics.push_back({std::string(scene_name) + "." + config.name +
+                             ".rays_per_sec",
+                         rays / seconds, "rays/s"});
+    }
+  }
+}
+
+void BenchManyLights(const BenchOptions& options,
+                     std::vector<Metric>& metrics) {
+  SceneParser scene_parser;
+  auto scene =
+      scene_parser.ParseScene("assignment4/" + std::string(kManyLightScene) + ".txt");
+  if (scene == nullptr) {
+    throw std::runtime_error("Failed at parsing " + std::string(kManyLightScene));
+  }
+
+  // Shadowed direct lighting from every light versus from a few sampled ones.
+  double ms[2];
+  size_t light_samples[2] = {0, options.light_samples};
+  for (int i = 0; i < 2; i++) {
+    Tracer tracer(scene_parser.GetCameraSpec(),
+                  glm::ivec2(options.many_light_size, options.many_light_size),
+                  0, scene_parser.GetBackgroundColor(),
+                  scene_parser.GetCubeMapPtr(), true, light_samples[i]);
+    auto start = Clock::now();
+    tracer.Render(*scene, "");
+    ms[i] = SecondsSince(start) * 1e3;
+  }
+  std::string prefix = std::string(kManyLightScene) + ".";
+  metrics.push_back({prefix + "all_lights.ms", ms[0], "ms"});
+  metrics.push_back({prefix + "sampled_lights.ms", ms[1], "ms"});
+  metrics.push_back({prefix + "light_sampling_speedup", ms[0] / ms[1], "x"});
+}
+
+void BenchIntersect(const BenchOptions& options, std::vector<Metric>& metrics) {
+  std::vector<Ray> rays = RandomRaysTowardOrigin(4096, 5.0f);
+  size_t hits;
+
+  glm::vec3 n(0.0f, 0.0f, 1.0f);
+  Triangle triangle(glm::vec3(-1.0f, -1.0f, 0.0f), glm::vec3(1.0f, -1.0f, 0.0f),
+                    glm::vec3(0.0f, 1.0f, 0.0f), n, n, n);
+  double ns = IntersectNanoseconds(triangle, rays, options.intersect_tests, hits);
+  metrics.push_back({"triangle_intersect.ns_per_test", ns, "ns"});
+
+  Sphere sphere(0.75f);
+  ns = IntersectNanoseconds(sphere, rays, options.intersect_tests, hits);
+  metrics.push_back({"sphere_intersect.ns_per_test", ns, "ns"});
+}
+
+void BenchCubeMap(const BenchOptions& options, std::vector<Metric>& metrics) {
+  CubeMap cube_map(GetAssetDir() + "assignment4/tex/church");
+  std::vector<Ray> rays = RandomRaysTowardOrigin(4096, 1.0f);
+
+  glm::vec3 sum(0.0f);
+  auto start = Clock::now();
+  for (size_t i = 0; i < options.intersect_tests; i++) {
+    sum += cube_map.GetTexel(rays[i % rays.size()].GetDirection());
+  }
+  double seconds = SecondsSince(start);
+  // Keep the lookups observable so they cannot be optimized away.
+  if (sum.x < 0.0f)
+    std::cerr << sum.x << std::endl;
+  metrics.push_back({"cubemap_get_texel.texels_per_sec",
+                     options.intersect_tests / seconds, "texels/s"});
+}
+
+bool ApplyThresholds(const std::string& filename, std::vector<Metric>& metrics) {
+  bool all_passed = true;
+  auto thresholds = LoadThresholds(filename);
+  for (Metric& metric : metrics) {
+    auto it = thresholds.find(metric.name);
+    if (it == thresholds.end())
+      continue;
+    metric.has_threshold = true;
+    metric.comparison = it->second.first;
+    metric.threshold = it->second.second;
+    if (metric.comparison == "max")
+      metric.passed = metric.value <= metric.threshold;
+    else
+      metric.passed = metric.value >= metric.threshold;
+    all_passed &= metric.passed;
+  }
+  return all_passed;
+}
+
+void WriteJSON(std::ostream& os,
+               const BenchOptions& options,
+               const std::vector<Metric>& metrics,
+               bool passed) {
+  os << "{\n";
+  os << "  \"config\": {\"width\": " << options.width
+     << ", \"height\": " << options.height
+     << ", \"bounces\": " << options.bounces
+     << ", \"intersect_tests\": " << options.intersect_tests
+     << ", \"octree_builds\": " << options.octree_builds
+     << ", \"light_samples\": " << options.light_samples
+     << ", \"many_light_size\": " << options.many_light_size << "},\n";
+  os << "  \"metrics\": [\n";
+  for (size_t i = 0; i < metrics.size(); i++) {
+    const Metric& metric = metrics[i];
+    os << "    {\"name\": \"" << metric.name << "\", \"value\": "
+       << metric.value << ", \"unit\": \"" << metric.unit << "\"";
+    if (metric.has_threshold) {
+      os << ", \"" << metric.comparison << "\": " << metric.threshold
+         << ", \"passed\": " << (metric.passed ? "true" : "false");
+    }
+    os << "}" << (i + 1 < metrics.size() ? "," : "") << "\n";
+  }
+  os << "  ],\n";
+  os << "  \"passed\": " << (passed ? "true" : "false") << "\n";
+  os << "}\n";
+}
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+  BenchOptions options = ParseOptions(argc, argv);
+
+  std::vector<Metric> metrics;
+  BenchOctree(options, metrics);
+  BenchScenes(options, metrics);
+  BenchManyLights(options, metrics);
+  BenchIntersect(options, metrics);
+  BenchCubeMap(options, metrics);
+
+  bool passed = true;
+  if (options.thresholds_file.size())
+    passed = ApplyThresholds(options.thresholds_file, metrics);
+
+  if (options.output_file.size()) {
+    std::ofstream ofs(options.output_file);
+    WriteJSON(ofs, options, metrics, passed);
+  }
+  WriteJSON(std::cout, options, metrics, passed);
+
+  for (const Metric& metric : metrics) {
+    if (metric.has_threshold && !metric.passed) {
+      std::cerr << "REGRESSION: " << metric.name << " = " << metric.value
+                << " (" << metric.comparison << " " << metric.threshold << ")"
+                << std::endl;
+    }
+  }
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,32 @@
+#ifndef PLAIN_TEXTURE_SHADER_H_
+#define PLAIN_TEXTURE_SHADER_H_
+
+#include "ShaderProgram.hpp"
+
+#include "gloo/gl_wrapper/Texture.hpp"
+#include "gloo/VertexObject.hpp"
+
+namespace GLOO {
+class PlainTextureShader : public ShaderProgram {
+ public:
+  PlainTextureShader();
+
+  void SetVertexObject(const VertexObject& obj) const;
+  void SetTexture(const Texture& texture, bool is_depth) const;
+
+  // When used through a ShadingComponent, the renderer only calls
+  // SetTargetNode; the node's quad is then drawn with the attached texture.
+  void SetTargetNode(const SceneNode& node,
+                     const glm::mat4& model_matrix) const override;
+  void AttachTexture(const Texture* texture) {
+    attached_texture_ = texture;
+  }
+
+ private:
+  void AssociateVertexArray(const VertexArray& vertex_array) const;
+
+  const Texture* attached_texture_{nullptr};
+};
+}  // namespace GLOO
+
+#endif